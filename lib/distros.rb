@@ -16,111 +16,179 @@
 module RandomVariable
 	class Bernoulli < Generic
 		# create a new <i>Bernoulli Random Variable</i> with 
-		# parameter +p+
-		def self.new(p)
-			intern_new(p)
+		# parameter +p+; besides the usual methods, +outcomes_bits+
+		# packs outcomes into a String a bit each and
+		# +count_successes+ just counts them
+		def self.new(p, generator: nil)
+			intern_new(p).with_generator(generator)
 		end
 	end
 
 	class Beta < Generic
 		# create a new <i>Beta Random Variable</i> with parameters 
 		# +alpha+ and +beta+
-		def self.new(alpha, beta)
-			intern_new(alpha, beta)
+		def self.new(alpha, beta, generator: nil)
+			intern_new(alpha, beta).with_generator(generator)
 		end
 	end
 
 	class Binomial < Generic
 		# create a new <i>Binomial Random Variable</i> with parameters 
 		# +n+ and +p+
-		def self.new(n, p)
-			intern_new(n, p)
+		def self.new(n, p, generator: nil)
+			intern_new(n, p).with_generator(generator)
+		end
+	end
+
+	class Categorical < Generic
+		# create a new <i>Categorical Random Variable</i> whose
+		# categories have the given +weights+, which need not add up
+		# to one; its outcomes are the indices of the categories or,
+		# if given, the corresponding elements of +values+ (packed
+		# outcomes are always the indices)
+		def self.new(weights, values = nil, generator: nil)
+			intern_new(weights, values).with_generator(generator)
 		end
 	end
 
 	class ChiSquared < Generic
 		# create a <i>Chi-Squared Random Variable</i> with +k+ degrees
 		# of freedom
-		def self.new(k)
-			intern_new(k)
+		def self.new(k, generator: nil)
+			intern_new(k).with_generator(generator)
 		end
 	end
 
 	class ContinuousUniform < Generic
 		# create a new <i>Continuous Uniform Random Variable</i> with 
 		# parameters +a+ and +b+
-		def self.new(a, b)
-			intern_new(a, b)
+		def self.new(a, b, generator: nil)
+			intern_new(a, b).with_generator(generator)
 		end	
 	end
 
 	class DiscreteUniform < Generic
 		# create a new <i>Discrete Uniform Random Variable</i> with 
 		# parameters +a+ and +b+
-		def self.new(a, b)
-			intern_new(a, b)
+		def self.new(a, b, generator: nil)
+			intern_new(a, b).with_generator(generator)
 		end
 	end
 
 	class Exponential < Generic
 		# create a new <i>Exponential Random Variable</i> with a mean of
 		# +mean+
-		def self.new(mean)
-			intern_new(mean)
+		def self.new(mean, generator: nil)
+			intern_new(mean).with_generator(generator)
 		end
 	end
 
+	class Expression < Generic
+		# the result of the arithmetic operators (+, -, *, /, % and **)
+		# on random variables of this library and numbers, evaluated
+		# natively: its outcomes are Integers if its operands are so,
+		# save for those too big for 64 bits, which raise RangeError
+		# instead of growing into Bignums; ** on two Integer operands is
+		# left to a block, as Ruby yields Integers or Rationals; a
+		# random variable appearing several times in it is sampled once
+		# per outcome, e.g. the outcomes of x - x are always zero
+		private_class_method :new
+	end
+
 	class F < Generic
 		# create a new <i>F Random Variable</i> with parameters 
 		# +d1+ and +d2+
-		def self.new(d1, d2)
-			intern_new(d1, d2)
+		def self.new(d1, d2, generator: nil)
+			intern_new(d1, d2).with_generator(generator)
+		end
+	end
+
+	class Gamma < Generic
+		# create a new <i>Gamma Random Variable</i> with parameters
+		# +shape+ and +scale+
+		def self.new(shape, scale = 1.0, generator: nil)
+			intern_new(shape, scale).with_generator(generator)
+		end
+	end
+
+	class Mixture < Generic
+		# create a new <i>Mixture</i> of the random variables in
+		# +components+, each outcome being that of a component chosen
+		# with the probability given by +weights+, which need not add
+		# up to one; the components of this library are sampled
+		# natively, a chunk of draws of the same component at a time
+		def self.new(components, weights, generator: nil)
+			unless components.is_a? Array and
+				components.all? { |c| c.is_a? Generic } then
+				raise TypeError, "the components must be " \
+						"random variables"
+			end
+			mixture = intern_new(components, weights)
+			unless mixture.nil?
+				return mixture.with_generator(generator)
+			end
+			choice = Categorical.new(weights, components,
+							generator: generator)
+			Generic.new { choice.outcome.outcome }
+		end
+	end
+
+	class MultivariateNormal < Generic
+		# create a new <i>Multivariate Normal Random Variable</i> with
+		# the +mean+ vector and the +covariance+ matrix, given as an
+		# Array of rows, which must be symmetric and positive definite;
+		# each outcome is an Array of as many Floats as +mean+ has,
+		# whereas packed outcomes lay them one after the other
+		def self.new(mean, covariance, generator: nil)
+			intern_new(mean, covariance).with_generator(generator)
 		end
 	end
 
 	class Normal < Generic
 		# create a new <i>Normal (aka Gaussian) Random Variable</i> 
 		# with parameters +mu+ and +sigma+
-		def self.new(mu = 0.0, sigma = 1.0)
-			intern_new(mu, sigma)
+		def self.new(mu = 0.0, sigma = 1.0, generator: nil)
+			intern_new(mu, sigma).with_generator(generator)
 		end
 	end
 
 	class Pareto < Generic
 		# create a new <i>Pareto Random Variable</i> where +a+ is the
 		# shape and +m+ is the location
-		def self.new(a, m = 1.0)
-			intern_new(a, m)
+		def self.new(a, m = 1.0, generator: nil)
+			intern_new(a, m).with_generator(generator)
 		end
 	end
 
 	class Poisson < Generic
 		# create a new <i>Poisson Random Variable</i> with a mean of
 		# +mean+
-		def self.new(mean)
-			intern_new(mean)
+		def self.new(mean, generator: nil)
+			intern_new(mean).with_generator(generator)
 		end
 	end
 
 	class Rademacher < Generic
-		# create a new <i>Rademacher Random Variable</i>
-		def self.new
-			intern_new
+		# create a new <i>Rademacher Random Variable</i>; as for
+		# Bernoulli, +outcomes_bits+ and +count_successes+ take the
+		# outcomes +1 as successes
+		def self.new(generator: nil)
+			intern_new.with_generator(generator)
 		end
 	end
 
 	class Rayleigh < Generic
 		# create a new <i>Rayleigh Random Variable</i> with parameter
 		# +sigma+
-		def self.new(sigma)
-			intern_new(sigma)
+		def self.new(sigma, generator: nil)
+			intern_new(sigma).with_generator(generator)
 		end
 	end
 
 	class Rectangular < Generic
 		# create a <i>Rectangular Random Variable</i>
-		def self.new
-			intern_new
+		def self.new(generator: nil)
+			intern_new.with_generator(generator)
 		end
 	end
 end
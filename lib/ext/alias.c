@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     alias.c                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/01/26                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+    random_variable gem for the creation or random variables in Ruby
+    Copyright (C) 2012 Jorge Fco. Madronal Rinaldi
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+/*******************************************************************************
+    Alias method for sampling from a discrete distribution in constant time
+
+    Walker, A.J. "An Efficient Method for Generating Discrete Random
+    Variables with General Distributions." ACM Transactions on
+    Mathematical Software, 3(3), 1977.
+
+    The table is built as in Vose, M.D. "A Linear Algorithm for
+    Generating Random Numbers with a Given Distribution." IEEE
+    Transactions on Software Engineering, 17(9), 1991.
+*******************************************************************************/
+
+#include <ruby.h>
+
+#include "alias.h"
+
+#define TWO_POW_64	18446744073709551616.0
+
+/* the table and its columns in a single block, so that it is released at
+   once by rv_alias_free() */
+rv_alias_t *rv_alias_alloc(long n)
+{
+	rv_alias_t *table;
+
+#ifndef __SIZEOF_INT128__
+	if (n > 0xffffffffL)
+		rb_raise(rb_eArgError, "too many categories");
+#endif
+	if (n < 1 || (unsigned long) n > (SIZE_MAX - sizeof(rv_alias_t)) /
+				(sizeof(uint64_t) + sizeof(long)))
+		rb_raise(rb_eArgError, "wrong number of categories");
+
+	table = xmalloc(sizeof(rv_alias_t) +
+			n * (sizeof(uint64_t) + sizeof(long)));
+	table->n = n;
+	table->cut = (uint64_t *) (table + 1);
+	table->alias = (long *) (table->cut + n);
+	return table;
+}
+
+void rv_alias_free(rv_alias_t *table)
+{
+	xfree(table);
+}
+
+/* weights are non-negative and add up to a positive finite number, they
+   are overwritten while building the table */
+void rv_alias_build(rv_alias_t *table, double *weights)
+{
+	long n = table->n, nr_small = 0, nr_large = 0, i, s, l;
+	long *work;
+	double sum = 0.0, scale, cut;
+
+	for (i = 0; i < n; i++)
+		sum += weights[i];
+	scale = n / sum;
+
+	/* the indices of the columns below the average fill work from its
+	   beginning, those above it from its end */
+	work = ALLOC_N(long, n);
+	for (i = 0; i < n; i++) {
+		weights[i] *= scale;
+		if (weights[i] < 1.0)
+			work[nr_small++] = i;
+		else
+			work[n - ++nr_large] = i;
+	}
+
+	while (nr_small > 0 && nr_large > 0) {
+		s = work[--nr_small];
+		l = work[n - nr_large];
+
+		/* column s is topped up with l */
+		cut = weights[s] * TWO_POW_64;
+		table->cut[s] = (cut < TWO_POW_64) ? 
+					(uint64_t) cut : UINT64_MAX;
+		table->alias[s] = l;
+
+		weights[l] = (weights[l] + weights[s]) - 1.0;
+		if (weights[l] < 1.0) {
+			nr_large--;
+			work[nr_small++] = l;
+		}
+	}
+
+	/* the remaining columns are full, short of rounding errors */
+	while (nr_large > 0) {
+		l = work[n - nr_large--];
+		table->cut[l] = UINT64_MAX;
+		table->alias[l] = l;
+	}
+	while (nr_small > 0) {
+		s = work[--nr_small];
+		table->cut[s] = UINT64_MAX;
+		table->alias[s] = s;
+	}
+	xfree(work);
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     alias.h                                                          //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/01/26                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _ALIAS_H_
+#define _ALIAS_H_
+
+#include <stdint.h>
+
+#include "gen.h"
+
+/* alias table over the categories 0 .. n-1: column i keeps i with
+   probability cut[i] / 2^64 and yields alias[i] otherwise */
+typedef struct {
+	long n;
+	uint64_t *cut;
+	long *alias;
+} rv_alias_t;
+
+extern rv_alias_t	*rv_alias_alloc(long n);
+extern void		rv_alias_free(rv_alias_t *);
+extern void		rv_alias_build(rv_alias_t *, double *weights);
+
+/* a category drawn out of a single 64-bit output: its high part, after
+   being multiplied by n, picks the column and its low part decides
+   between the column and its alias */
+static inline long rv_alias_draw(const rv_alias_t *table, rv_gen_t *gen)
+{
+	uint64_t x = rv_gen_next(gen), lo;
+	long i;
+#ifdef __SIZEOF_INT128__
+	__uint128_t m = (__uint128_t) x * (uint64_t) table->n;
+
+	i = (long) (m >> 64);
+	lo = (uint64_t) m;
+#else
+	uint64_t x_hi = x >> 32, x_lo = x & 0xffffffffULL;
+	uint64_t n = (uint64_t) table->n, t;
+
+	/* n < 2^32 is enforced by rv_alias_alloc() in this case */
+	t = x_lo * n;
+	lo = t & 0xffffffffULL;
+	t = x_hi * n + (t >> 32);
+	i = (long) (t >> 32);
+	lo |= t << 32;
+#endif
+	return (lo < table->cut[i]) ? i : table->alias[i];
+}
+
+#endif /* _ALIAS_H_ */
@@ -0,0 +1,302 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     expr.c                                                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/02/02                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+    random_variable gem for the creation or random variables in Ruby
+    Copyright (C) 2012 Jorge Fco. Madronal Rinaldi
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#else
+#error "No math.h header found"
+#endif /* HAVE_MATH_H */
+
+#ifdef HAVE_LIMITS_H
+#include <limits.h>
+#else
+#error "No limits.h header found"
+#endif /* HAVE_LIMITS_H */
+
+#include "expr.h"
+
+/* a + b, a - b and a * b, *overflow being set if the result does not fit
+   in a long, in which case it wraps around */
+static inline long long_add(long a, long b, int *overflow)
+{
+#ifdef __GNUC__
+	long res;
+
+	*overflow |= __builtin_add_overflow(a, b, &res);
+	return res;
+#else
+	if ((b > 0 && a > LONG_MAX - b) || (b < 0 && a < LONG_MIN - b))
+		*overflow = 1;
+	return (long) ((unsigned long) a + (unsigned long) b);
+#endif
+}
+
+static inline long long_sub(long a, long b, int *overflow)
+{
+#ifdef __GNUC__
+	long res;
+
+	*overflow |= __builtin_sub_overflow(a, b, &res);
+	return res;
+#else
+	if ((b < 0 && a > LONG_MAX + b) || (b > 0 && a < LONG_MIN + b))
+		*overflow = 1;
+	return (long) ((unsigned long) a - (unsigned long) b);
+#endif
+}
+
+static inline long long_mul(long a, long b, int *overflow)
+{
+#ifdef __GNUC__
+	long res;
+
+	*overflow |= __builtin_mul_overflow(a, b, &res);
+	return res;
+#else
+	long res = (long) ((unsigned long) a * (unsigned long) b);
+
+	/* LONG_MIN / -1 would trap */
+	if (0 != a && ((-1 == a && LONG_MIN == b) || res / a != b))
+		*overflow = 1;
+	return res;
+#endif
+}
+
+/* a op b as Ruby's Integer does it, as long as the result fits in a long;
+   it returns RV_OP_ZERO_DIV on division by zero and RV_OP_OVERFLOW where
+   Ruby would yield a Bignum */
+int rv_op_long(rv_op_t op, long a, long b, long *res)
+{
+	int overflow = 0;
+	long q, r;
+
+	switch (op) {
+	case rv_op_add:
+		*res = long_add(a, b, &overflow);
+		break;
+	case rv_op_sub:
+		*res = long_sub(a, b, &overflow);
+		break;
+	case rv_op_mul:
+		*res = long_mul(a, b, &overflow);
+		break;
+	case rv_op_div:
+	case rv_op_mod:
+		if (0 == b)
+			return RV_OP_ZERO_DIV;
+		/* LONG_MIN / -1 would trap, it is the only quotient that
+		   does not fit in a long */
+		if (-1 == b) {
+			q = long_sub(0, a, &overflow);
+			overflow &= (rv_op_div == op);
+			r = 0;
+		} else {
+			q = a / b;
+			r = a % b;
+		}
+		/* both of them rounded towards minus infinity */
+		if (0 != r && ((r < 0) != (b < 0))) {
+			q--;
+			r += b;
+		}
+		*res = (rv_op_div == op) ? q : r;
+		break;
+	default:
+		*res = 0;
+		break;
+	}
+	return overflow ? RV_OP_OVERFLOW : 0;
+}
+
+static inline double float_mod(double a, double b)
+{
+	double mod;
+
+	if (isinf(b) && !isinf(a))
+		mod = a;
+	else
+		mod = fmod(a, b);
+	if (b * mod < 0)
+		mod += b;
+	return mod;
+}
+
+/* the unary operators, in the order of rv_op_t */
+static double (* const unary_func[RV_NR_OPS - rv_op_acos])(double) = {
+	acos, acosh, asin, asinh, atan, atanh, cbrt, cos, cosh, erf, erfc,
+	exp, tgamma, log, log10, log2, sin, sinh, sqrt, tan, tanh
+};
+
+/* a op b as Ruby's Float does it, except for ** yielding NaN where Ruby
+   yields a Complex, and for the unary operators yielding NaN where Ruby
+   raises Math::DomainError */
+double rv_op_double(rv_op_t op, double a, double b)
+{
+	if (RV_OP_IS_UNARY(op))
+		return (*unary_func[op - rv_op_acos])(a);
+
+	switch (op) {
+	case rv_op_add:
+		return a + b;
+	case rv_op_sub:
+		return a - b;
+	case rv_op_mul:
+		return a * b;
+	case rv_op_div:
+		return a / b;
+	case rv_op_mod:
+		return float_mod(a, b);
+	case rv_op_pow:
+		return pow(a, b);
+	default:
+		return 0.0;
+	}
+}
+
+/******************************************************************************/
+/* operators over columns, kept as plain loops the compiler can vectorize */
+/******************************************************************************/
+#define OP_LOOP(member, expr)						\
+	do {								\
+		if (a_step && b_step) {					\
+			for (i = 0; i < n; i++) {			\
+				x = a[i].member;			\
+				y = b[i].member;			\
+				out[i].member = (expr);			\
+			}						\
+		} else if (a_step) {					\
+			y = b->member;					\
+			for (i = 0; i < n; i++) {			\
+				x = a[i].member;			\
+				out[i].member = (expr);			\
+			}						\
+		} else if (b_step) {					\
+			x = a->member;					\
+			for (i = 0; i < n; i++) {			\
+				y = b[i].member;			\
+				out[i].member = (expr);			\
+			}						\
+		} else {						\
+			x = a->member;					\
+			y = b->member;					\
+			for (i = 0; i < n; i++)				\
+				out[i].member = (expr);			\
+		}							\
+	} while (0)
+
+/* it returns what rv_op_long() does, out being left half done on
+   division by zero; the overflows of a column are only told at its end */
+int rv_op_long_n(rv_op_t op, rv_value_t *out, const rv_value_t *a, int a_step,
+			const rv_value_t *b, int b_step, long n)
+{
+	int overflow = 0, ret;
+	long x, y, i;
+
+	switch (op) {
+	case rv_op_add:
+		OP_LOOP(l, long_add(x, y, &overflow));
+		return overflow ? RV_OP_OVERFLOW : 0;
+	case rv_op_sub:
+		OP_LOOP(l, long_sub(x, y, &overflow));
+		return overflow ? RV_OP_OVERFLOW : 0;
+	case rv_op_mul:
+		OP_LOOP(l, long_mul(x, y, &overflow));
+		return overflow ? RV_OP_OVERFLOW : 0;
+	default:
+		break;
+	}
+
+	/* the divisions, where Ruby's rounding has to be dealt with */
+	for (i = 0; i < n; i++) {
+		ret = rv_op_long(op, a_step ? a[i].l : a->l,
+				b_step ? b[i].l : b->l, &out[i].l);
+		if (RV_OP_ZERO_DIV == ret)
+			return ret;
+		if (RV_OP_OVERFLOW == ret)
+			overflow = 1;
+	}
+	return overflow ? RV_OP_OVERFLOW : 0;
+}
+
+void rv_op_double_n(rv_op_t op, rv_value_t *out, 
+			const rv_value_t *a, int a_step,
+			const rv_value_t *b, int b_step, long n)
+{
+	double x, y;
+	long i;
+
+	if (RV_OP_IS_UNARY(op)) {
+		double (*func)(double) = unary_func[op - rv_op_acos];
+
+		if (a_step)
+			for (i = 0; i < n; i++)
+				out[i].d = (*func)(a[i].d);
+		else
+			for (x = (*func)(a->d), i = 0; i < n; i++)
+				out[i].d = x;
+		return;
+	}
+
+	switch (op) {
+	case rv_op_add:
+		OP_LOOP(d, x + y);
+		break;
+	case rv_op_sub:
+		OP_LOOP(d, x - y);
+		break;
+	case rv_op_mul:
+		OP_LOOP(d, x * y);
+		break;
+	case rv_op_div:
+		OP_LOOP(d, x / y);
+		break;
+	case rv_op_mod:
+		OP_LOOP(d, float_mod(x, y));
+		break;
+	case rv_op_pow:
+		OP_LOOP(d, pow(x, y));
+		break;
+	default:
+		break;
+	}
+}
+#undef OP_LOOP
+
+/* the longs of src turned into doubles in dst, which may be src itself */
+void rv_value_to_double_n(rv_value_t *dst, const rv_value_t *src, long n)
+{
+	long i;
+
+	for (i = 0; i < n; i++)
+		dst[i].d = (double) src[i].l;
+}
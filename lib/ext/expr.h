@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     expr.h                                                           //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/02/02                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _EXPR_H_
+#define _EXPR_H_
+
+/* operators of the expressions over random variables */
+typedef enum {
+	rv_op_add = 0,
+	rv_op_sub,
+	rv_op_mul,
+	rv_op_div,
+	rv_op_mod,
+	rv_op_pow,
+
+	/* unary operators, the functions of Ruby's Math module */
+	rv_op_acos,
+	rv_op_acosh,
+	rv_op_asin,
+	rv_op_asinh,
+	rv_op_atan,
+	rv_op_atanh,
+	rv_op_cbrt,
+	rv_op_cos,
+	rv_op_cosh,
+	rv_op_erf,
+	rv_op_erfc,
+	rv_op_exp,
+	rv_op_gamma,
+	rv_op_log,
+	rv_op_log10,
+	rv_op_log2,
+	rv_op_sin,
+	rv_op_sinh,
+	rv_op_sqrt,
+	rv_op_tan,
+	rv_op_tanh,
+
+	RV_NR_OPS /* has to be the last element in the enum */
+} rv_op_t;
+
+/* unary operators ignore their second operand */
+#define RV_OP_IS_UNARY(op)	((op) > rv_op_pow)
+
+/* a native value, whether a double or a long is told apart elsewhere */
+typedef union {
+	double d;
+	long l;
+} rv_value_t;
+
+/* whether the operator yields a long out of two longs */
+#define RV_OP_KEEPS_LONG(op)	((op) < rv_op_pow)
+
+/* what rv_op_long() returns when the result is not a long */
+#define RV_OP_ZERO_DIV	(-1)
+#define RV_OP_OVERFLOW	(-2)
+
+extern int	rv_op_long(rv_op_t op, long a, long b, long *res);
+extern double	rv_op_double(rv_op_t op, double a, double b);
+
+/* the same over columns of n values: out[i] = a[i] op b[i], an operand
+   whose step is zero holding a single value used for every i */
+extern int	rv_op_long_n(rv_op_t op, rv_value_t *out,
+			const rv_value_t *a, int a_step,
+			const rv_value_t *b, int b_step, long n);
+extern void	rv_op_double_n(rv_op_t op, rv_value_t *out,
+			const rv_value_t *a, int a_step,
+			const rv_value_t *b, int b_step, long n);
+extern void	rv_value_to_double_n(rv_value_t *dst,
+				const rv_value_t *src, long n);
+
+#endif /* _EXPR_H_ */
@@ -6,4 +6,9 @@ have_header 'stdarg.h'
 have_header 'math.h'
 have_header 'limits.h'
 have_header 'float.h'
+have_header 'unistd.h'
+have_header 'pthread.h'
+have_header 'ruby/thread.h'
+have_func 'rb_thread_call_without_gvl', 'ruby/thread.h'
+have_header 'ruby/io/buffer.h'
 create_makefile 'random_variable'
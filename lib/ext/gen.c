@@ -15,57 +15,292 @@
 
 #include <ruby.h>
 
-/* The Ruby "Random" class */
+#include "gen.h"
+
+/* The Ruby "Random" class, only used for obtaining fresh seeds */
 extern VALUE rb_cRandom;
 
-/* the random number generator (instance) */
-static VALUE rb_RandGen = Qnil;
+/* the RandomVariable::Generator class */
+static VALUE rb_cGenerator = Qnil;
+
+/* the generator used by random variables not bound to any generator */
+static VALUE rb_default_gen = Qnil;
+static rv_gen_t *rv_default_gen = NULL;
+
+/* the algorithms used by the samplers */
+rv_algorithm_t rv_algorithm = rv_algorithm_fast;
+
+/* the generator ranf() draws from, see rv_gen_select() */
+#ifdef RV_THREAD_LOCAL
+static RV_THREAD_LOCAL rv_gen_t *rv_cur_gen = NULL;
+#else
+static rv_gen_t *rv_cur_gen = NULL;
+#endif
 
 /* For returning a random number at the C level */
-#define GET_RB_RANF	rb_funcall(rb_RandGen, rb_intern("rand"), 0)
 double ranf(void)
 {
-	return NUM2DBL(GET_RB_RANF);
+	return rv_gen_ranf(rv_cur_gen);
+}
+
+/* For returning the raw 64-bit output at the C level */
+uint64_t ranu64(void)
+{
+	return rv_gen_next(rv_cur_gen);
+}
+
+/* the generator selected on the calling thread, for tight loops */
+rv_gen_t *rv_gen_current(void)
+{
+	return rv_cur_gen;
 }
 
 /* For returning a random number at the Ruby level */
 VALUE rb_ranf(void)
 {
-	return GET_RB_RANF;
+	return DBL2NUM(ranf());
+}
+
+/******************************************************************************/
+/* seeding */
+/******************************************************************************/
+
+/* SplitMix64 (Vigna), used for expanding a seed into the generator state */
+static inline uint64_t splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* the seed can be an arbitrarily large Integer: every 64-bit word of its
+   absolute value (and its sign) is mixed into the generator state */
+static void gen_seed(rv_gen_t *gen, VALUE rb_value)
+{
+	size_t i, nr_words;
+	uint64_t *words, x;
+	int sign;
+
+	nr_words = rb_absint_numwords(rb_value, 64, NULL);
+	if (0 == nr_words)
+		nr_words = 1;
+	words = ALLOC_N(uint64_t, nr_words);
+	sign = rb_integer_pack(rb_value, words, nr_words, sizeof(uint64_t), 0,
+			INTEGER_PACK_LSWORD_FIRST |
+			INTEGER_PACK_NATIVE_BYTE_ORDER);
+
+	x = (sign < 0) ? ~(uint64_t) 0 : 0;
+	for (i = 0; i < nr_words; i++) {
+		x ^= words[i];
+		x = splitmix64(&x);
+	}
+	xfree(words);
+
+	for (i = 0; i < 4; i++)
+		gen->s[i] = splitmix64(&x);
+}
+
+/******************************************************************************/
+/* jumping ahead */
+/******************************************************************************/
+static void gen_advance(rv_gen_t *gen, const uint64_t poly[4])
+{
+	uint64_t s[4] = { 0, 0, 0, 0 };
+	int i, b;
+
+	for (i = 0; i < 4; i++)
+		for (b = 0; b < 64; b++) {
+			if (poly[i] & ((uint64_t) 1 << b)) {
+				s[0] ^= gen->s[0];
+				s[1] ^= gen->s[1];
+				s[2] ^= gen->s[2];
+				s[3] ^= gen->s[3];
+			}
+			rv_gen_next(gen);
+		}
+
+	for (i = 0; i < 4; i++)
+		gen->s[i] = s[i];
+}
+
+/* equivalent to 2^128 calls to rv_gen_next() */
+void rv_gen_jump(rv_gen_t *gen)
+{
+	static const uint64_t jump[4] = {
+		0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+		0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+	};
+	gen_advance(gen, jump);
+}
+
+/* equivalent to 2^192 calls to rv_gen_next() */
+void rv_gen_long_jump(rv_gen_t *gen)
+{
+	static const uint64_t long_jump[4] = {
+		0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+		0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+	};
+	gen_advance(gen, long_jump);
 }
-#undef GET_RB_RANF
 
 /******************************************************************************/
 /* Functions at C level	*/
 /******************************************************************************/
 
+/* select the generator subsequent ranf() calls on the calling native
+   thread draw from, NULL selects the default one; it must be called
+   before sampling on behalf of any random variable */
+void rv_gen_select(rv_gen_t *gen)
+{
+	rv_cur_gen = (NULL == gen) ? rv_default_gen : gen;
+}
+
+static void rv_gen_mark(rv_generator_t *generator)
+{
+	rb_gc_mark(generator->rb_seed);
+}
+
+/* the new generator is seeded with 0 until it is initialized, as xoshiro
+   would only draw zeros out of the all-zero state */
+VALUE rv_gen_alloc(VALUE klass)
+{
+	rv_generator_t *generator;
+	VALUE rb_generator;
+
+	rb_generator = Data_Make_Struct(klass, rv_generator_t,
+					rv_gen_mark, xfree, generator);
+	gen_seed(&generator->gen, INT2FIX(0));
+	generator->rb_seed = INT2FIX(0);
+	return rb_generator;
+}
+
+#define GET_GENERATOR(rb_obj, generator)				\
+	do {								\
+		if (!rb_obj_is_kind_of((rb_obj), rb_cGenerator))	\
+			rb_raise(rb_eTypeError, "not a "		\
+				"RandomVariable::Generator");		\
+		Data_Get_Struct((rb_obj), rv_generator_t, (generator));\
+	} while (0)
+
+/* get the state of a Ruby generator object */
+rv_gen_t *rv_gen_get(VALUE rb_generator)
+{
+	rv_generator_t *generator;
+
+	GET_GENERATOR(rb_generator, generator);
+	return &generator->gen;
+}
+
+/* get the default generator */
+VALUE rv_gen_default(void)
+{
+	return rb_default_gen;
+}
+
 /* get the current seed */
-VALUE rv_gen_get_seed(void)
+VALUE rv_gen_get_seed(VALUE rb_generator)
 {
-	return rb_funcall(rb_RandGen, rb_intern("seed"), 0);
+	rv_generator_t *generator;
+
+	GET_GENERATOR(rb_generator, generator);
+	return generator->rb_seed;
 }
 
 /* set the current seed */
-void rv_gen_set_seed(VALUE rb_seed)
+void rv_gen_set_seed(VALUE rb_generator, VALUE rb_new_seed)
 {
-	/* memory leak?! */
-	rb_RandGen = rb_funcall(rb_cRandom, rb_intern("new"), 1, rb_seed);
+	rv_generator_t *generator;
+
+	GET_GENERATOR(rb_generator, generator);
+	rb_new_seed = rb_to_int(rb_new_seed);
+	gen_seed(&generator->gen, rb_new_seed);
+	generator->rb_seed = rb_new_seed;
+}
+
+/* make rb_dest continue the stream of rb_src from its current state */
+void rv_gen_copy(VALUE rb_dest, VALUE rb_src)
+{
+	rv_generator_t *dest, *src;
+
+	GET_GENERATOR(rb_dest, dest);
+	GET_GENERATOR(rb_src, src);
+	*dest = *src;
+}
+
+/* the state as an array of four Integers */
+VALUE rv_gen_get_state(VALUE rb_generator)
+{
+	rv_generator_t *generator;
+	VALUE rb_state;
+	int i;
+
+	GET_GENERATOR(rb_generator, generator);
+	rb_state = rb_ary_new_capa(4);
+	for (i = 0; i < 4; i++)
+		rb_ary_push(rb_state, ULL2NUM(generator->gen.s[i]));
+	return rb_state;
 }
 
-VALUE rv_gen_new_seed(void)
+/* restore a generator to a seed and state given by rv_gen_get_seed() and
+   rv_gen_get_state() */
+void rv_gen_restore(VALUE rb_generator, VALUE rb_seed, VALUE rb_state)
 {
-	rb_RandGen = rb_funcall(rb_cRandom, rb_intern("new"), 0);
-	return rv_gen_get_seed();
+	rv_generator_t *generator;
+	uint64_t s[4];
+	int i;
+
+	GET_GENERATOR(rb_generator, generator);
+	Check_Type(rb_state, T_ARRAY);
+	if (4 != RARRAY_LEN(rb_state))
+		rb_raise(rb_eArgError, "wrong generator state length");
+	for (i = 0; i < 4; i++)
+		s[i] = NUM2ULL(rb_ary_entry(rb_state, i));
+	if (0 == (s[0] | s[1] | s[2] | s[3]))
+		rb_raise(rb_eArgError, "the generator state cannot be zero");
+	for (i = 0; i < 4; i++)
+		generator->gen.s[i] = s[i];
+	generator->rb_seed = NIL_P(rb_seed) ? Qnil : rb_to_int(rb_seed);
+}
+
+/* a new generator going on with the stream of rb_generator for 2^128
+   draws, while rb_generator itself jumps past them; the new generator has
+   no seed as it cannot be recreated from an Integer */
+VALUE rv_gen_split(VALUE rb_generator)
+{
+	rv_generator_t *generator, *child;
+	VALUE rb_child;
+
+	GET_GENERATOR(rb_generator, generator);
+	rb_child = rv_gen_alloc(rb_obj_class(rb_generator));
+	Data_Get_Struct(rb_child, rv_generator_t, child);
+	child->gen = generator->gen;
+	child->rb_seed = Qnil;
+	rv_gen_jump(&generator->gen);
+	return rb_child;
 }
+
+VALUE rv_gen_new_seed(VALUE rb_generator)
+{
+	rv_gen_set_seed(rb_generator,
+			rb_funcall(rb_cRandom, rb_intern("new_seed"), 0));
+	return rv_gen_get_seed(rb_generator);
+}
+#undef GET_GENERATOR
 /******************************************************************************/
 
 
 /* Must be called BEFORE any kind ranf() call !! */
-void rv_init_gen(void)
+void rv_init_gen(VALUE rb_klass)
 {
-	/* create an instance of the random generator */
-	rv_gen_new_seed();
+	rb_cGenerator = rb_klass;
+
+	/* tell the GC not to collect the default generator */
+	rb_gc_register_address(&rb_default_gen);
 
-	/* tell the GC not to collect the random generator */
-	rb_gc_register_address(&rb_RandGen);
+	/* create and seed the default generator */
+	rb_default_gen = rv_gen_alloc(rb_cGenerator);
+	rv_default_gen = rv_gen_get(rb_default_gen);
+	rv_gen_new_seed(rb_default_gen);
+	rv_gen_select(NULL);
 }
@@ -18,11 +18,84 @@
 #define __GEN_H__
 
 #include <ruby.h>
+#include <stdint.h>
 
-void rv_init_gen(void);
+/* the generator selected for ranf() is kept per native thread */
+#if defined(__GNUC__)
+#define RV_THREAD_LOCAL	__thread
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define RV_THREAD_LOCAL	_Thread_local
+#endif
+
+/******************************************************************************/
+/* xoshiro256++ state (Blackman & Vigna, 2019) */
+/******************************************************************************/
+typedef struct {
+	uint64_t s[4];
+} rv_gen_t;
+
+static inline uint64_t rv_gen_rotl(const uint64_t x, int k)
+{
+	return (x << k) | (x >> (64 - k));
+}
+
+/* next raw 64-bit output of the generator */
+static inline uint64_t rv_gen_next(rv_gen_t *gen)
+{
+	uint64_t *s = gen->s;
+	const uint64_t result = rv_gen_rotl(s[0] + s[3], 23) + s[0];
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+
+	s[2] ^= t;
+	s[3] = rv_gen_rotl(s[3], 45);
+
+	return result;
+}
+
+/* uniform double over the open interval (0,1), 52 bits of precision */
+static inline double rv_gen_ranf(rv_gen_t *gen)
+{
+	return ((rv_gen_next(gen) >> 12) + 0.5) * (1.0 / 4503599627370496.0);
+}
+
+/******************************************************************************/
+/* state behind a RandomVariable::Generator object */
+/******************************************************************************/
+typedef struct {
+	rv_gen_t gen;
+	VALUE rb_seed;
+} rv_generator_t;
+
+/******************************************************************************/
+/* algorithms used by the samplers */
+/******************************************************************************/
+typedef enum {
+	rv_algorithm_fast = 0,	/* ziggurat and friends */
+	rv_algorithm_classic	/* those of randlib, as in former releases */
+} rv_algorithm_t;
+extern rv_algorithm_t rv_algorithm;
+
+void rv_init_gen(VALUE);
 double ranf(void);
-VALUE rv_gen_new_seed(void);
-void rv_gen_set_seed(VALUE);
-VALUE rv_gen_get_seed(void);
+uint64_t ranu64(void);
+rv_gen_t *rv_gen_current(void);
+void rv_gen_jump(rv_gen_t *);
+void rv_gen_long_jump(rv_gen_t *);
+void rv_gen_select(rv_gen_t *);
+rv_gen_t *rv_gen_get(VALUE);
+VALUE rv_gen_alloc(VALUE);
+VALUE rv_gen_default(void);
+VALUE rv_gen_new_seed(VALUE);
+void rv_gen_set_seed(VALUE, VALUE);
+VALUE rv_gen_get_seed(VALUE);
+void rv_gen_copy(VALUE, VALUE);
+VALUE rv_gen_get_state(VALUE);
+void rv_gen_restore(VALUE, VALUE, VALUE);
+VALUE rv_gen_split(VALUE);
 
 #endif /* __GEN_H__ */
@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     histogram.c                                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/03/02                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+    random_variable gem for the creation or random variables in Ruby
+    Copyright (C) 2012 Jorge Fco. Madronal Rinaldi
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+/*******************************************************************************
+    Histograms of fixed layout, linear or log-linear
+
+    The log layout is the one of HdrHistogram: the bin of a positive double
+    is its exponent followed by the top bits of its mantissa, that is, the
+    top bits of its representation, so no logarithm is taken and every
+    power of two is split in 2^bits bins of the same width.  Both layouts
+    are fixed at creation, counts of the same layout merging by addition
+    whatever the order the samples were added in.
+*******************************************************************************/
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#else
+#error "No math.h header found"
+#endif /* HAVE_MATH_H */
+
+#include <ruby.h>
+
+#include "histogram.h"
+
+#define MAX_NR_BINS	(1L << 24)
+#define MAX_BITS	16
+
+static rv_histogram_t *alloc(rv_histogram_scale_t scale, long nr_bins)
+{
+	rv_histogram_t *h;
+
+	/* a single block, released at once by rv_histogram_free() */
+	h = xmalloc(sizeof(rv_histogram_t) + (nr_bins + 2) * sizeof(int64_t));
+	h->scale = scale;
+	h->nr_bins = nr_bins;
+	h->counts = (int64_t *) (h + 1);
+	rv_histogram_reset(h);
+	return h;
+}
+
+static int64_t key_of(double x, int shift)
+{
+	uint64_t bits;
+
+	memcpy(&bits, &x, sizeof bits);
+	return (int64_t) (bits >> shift);
+}
+
+static double double_of(int64_t key, int shift)
+{
+	uint64_t bits = (uint64_t) key << shift;
+	double x;
+
+	memcpy(&x, &bits, sizeof x);
+	return x;
+}
+
+rv_histogram_t *rv_histogram_alloc_linear(double lo, double hi, long nr_bins)
+{
+	rv_histogram_t *h;
+
+	if (!isfinite(lo) || !isfinite(hi) || !(lo < hi))
+		rb_raise(rb_eArgError, "the range must be finite and "
+							"not empty");
+	if (nr_bins < 1 || nr_bins > MAX_NR_BINS)
+		rb_raise(rb_eArgError, "the number of bins must be between "
+						"1 and %ld", MAX_NR_BINS);
+	if (!isfinite(hi - lo))
+		rb_raise(rb_eArgError, "the range is too wide");
+
+	h = alloc(rv_histogram_linear, nr_bins);
+	h->lo = lo;
+	h->hi = hi;
+	h->factor = nr_bins / (hi - lo);
+	h->shift = 0;
+	h->first = 0;
+	return h;
+}
+
+/* lo is rounded down and hi up to the edges of their bins */
+rv_histogram_t *rv_histogram_alloc_log(double lo, double hi, int bits)
+{
+	rv_histogram_t *h;
+	int shift;
+	int64_t first, last;
+
+	if (!isfinite(lo) || !isfinite(hi) || !(lo < hi) || !(lo > 0.0))
+		rb_raise(rb_eArgError, "the range must be finite, positive "
+							"and not empty");
+	if (bits < 0 || bits > MAX_BITS)
+		rb_raise(rb_eArgError, "the bins per power of two must be "
+			"a power of two between 1 and %d", 1 << MAX_BITS);
+
+	/* the 52 bits of the mantissa but the top ones kept */
+	shift = 52 - bits;
+	first = key_of(lo, shift);
+	/* hi itself is left out */
+	last = key_of(nextafter(hi, 0.0), shift);
+	if (last - first + 1 > MAX_NR_BINS)
+		rb_raise(rb_eArgError, "too many bins, more than %ld",
+								MAX_NR_BINS);
+
+	h = alloc(rv_histogram_log, (long) (last - first + 1));
+	h->shift = shift;
+	h->first = first;
+	h->lo = double_of(first, shift);
+	h->hi = double_of(last + 1, shift);
+	h->factor = 0.0;
+	return h;
+}
+
+rv_histogram_t *rv_histogram_alloc_like(const rv_histogram_t *other)
+{
+	rv_histogram_t *h = alloc(other->scale, other->nr_bins);
+
+	h->lo = other->lo;
+	h->hi = other->hi;
+	h->factor = other->factor;
+	h->shift = other->shift;
+	h->first = other->first;
+	return h;
+}
+
+void rv_histogram_free(rv_histogram_t *h)
+{
+	xfree(h);
+}
+
+void rv_histogram_reset(rv_histogram_t *h)
+{
+	memset(h->counts, 0, (h->nr_bins + 2) * sizeof(int64_t));
+}
+
+int rv_histogram_same_layout(const rv_histogram_t *a, const rv_histogram_t *b)
+{
+	return a->scale == b->scale && a->nr_bins == b->nr_bins &&
+		a->lo == b->lo && a->hi == b->hi && a->shift == b->shift;
+}
+
+void rv_histogram_merge(rv_histogram_t *h, const rv_histogram_t *other)
+{
+	long i;
+
+	for (i = 0; i < h->nr_bins + 2; i++)
+		h->counts[i] += other->counts[i];
+}
+
+double rv_histogram_edge(const rv_histogram_t *h, long i)
+{
+	if (rv_histogram_log == h->scale)
+		return double_of(h->first + i, h->shift);
+	/* exact at both ends */
+	if (i == h->nr_bins)
+		return h->hi;
+	return h->lo + (h->hi - h->lo) * ((double) i / h->nr_bins);
+}
+
+/* the scale is told apart once, outside of the loops */
+void rv_histogram_add_n(rv_histogram_t *h, const double *x, long n)
+{
+	int64_t *counts = h->counts;
+	long i;
+
+	if (rv_histogram_linear == h->scale) {
+		const double lo = h->lo, factor = h->factor;
+		const double top = (double) (h->nr_bins + 1);
+		double t;
+
+		for (i = 0; i < n; i++) {
+			t = floor((x[i] - lo) * factor) + 1.0;
+			counts[(long) fmin(fmax(t, 0.0), top)]++;
+		}
+	} else {
+		for (i = 0; i < n; i++)
+			counts[rv_histogram_index(h, x[i])]++;
+	}
+}
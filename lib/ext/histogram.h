@@ -0,0 +1,91 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     histogram.h                                                      //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/03/02                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef enum {
+	rv_histogram_linear = 0,
+	rv_histogram_log
+} rv_histogram_scale_t;
+
+/* counts of the samples falling in each bin of a fixed layout: nr_bins
+   bins of the same width over [lo, hi) when linear, or, when log, bins
+   splitting every power of two in 2^bits of the same width over [lo, hi)
+   for a positive lo, so that their relative width is at most 2^-bits, as
+   in an HDR histogram.  counts[0] holds the samples below lo and
+   counts[nr_bins + 1] those from hi on, NaN landing in either of them */
+typedef struct {
+	rv_histogram_scale_t scale;
+	long nr_bins;
+	double lo, hi;
+	double factor;		/* nr_bins / (hi - lo), when linear */
+	int shift;		/* 52 - bits, when log */
+	int64_t first;		/* key of the first bin, when log */
+	int64_t *counts;
+} rv_histogram_t;
+
+/* ArgumentError when the layout is not valid */
+extern rv_histogram_t	*rv_histogram_alloc_linear(double lo, double hi,
+								long nr_bins);
+extern rv_histogram_t	*rv_histogram_alloc_log(double lo, double hi,
+								int bits);
+/* another histogram with the same layout, empty */
+extern rv_histogram_t	*rv_histogram_alloc_like(const rv_histogram_t *);
+extern void		rv_histogram_free(rv_histogram_t *);
+extern void		rv_histogram_reset(rv_histogram_t *);
+extern int		rv_histogram_same_layout(const rv_histogram_t *,
+						const rv_histogram_t *);
+/* both of them must have the same layout */
+extern void		rv_histogram_merge(rv_histogram_t *,
+						const rv_histogram_t *other);
+/* lower edge of the i-th bin, hi for i = nr_bins */
+extern double		rv_histogram_edge(const rv_histogram_t *, long i);
+extern void		rv_histogram_add_n(rv_histogram_t *,
+						const double *x, long n);
+
+/* the index into counts of x, computed without branches: the linear one
+   clamps with fmin and fmax, the log one takes the exponent and the top
+   bits of the mantissa of x straight out of its representation */
+static inline long rv_histogram_index(const rv_histogram_t *h, double x)
+{
+	double t;
+	uint64_t bits;
+	int64_t k;
+
+	if (rv_histogram_linear == h->scale) {
+		t = floor((x - h->lo) * h->factor) + 1.0;
+		t = fmin(fmax(t, 0.0), (double) (h->nr_bins + 1));
+		return (long) t;
+	}
+
+	memcpy(&bits, &x, sizeof bits);
+	k = (int64_t) ((bits & ~(1ULL << 63)) >> h->shift) - h->first + 1;
+	k = (bits >> 63) ? 0 : k;
+	k = (k < 0) ? 0 : k;
+	return (k > h->nr_bins) ? h->nr_bins + 1 : k;
+}
+
+static inline void rv_histogram_add(rv_histogram_t *h, double x)
+{
+	h->counts[rv_histogram_index(h, x)]++;
+}
+
+#endif /* _HISTOGRAM_H_ */
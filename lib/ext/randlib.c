@@ -1,5 +1,6 @@
 #include "randlib.h"
 #include "gen.h"
+#include "ziggurat.h"
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
@@ -8,6 +9,10 @@
 #define max(a,b) ((a) >= (b) ? (a) : (b))
 void ftnstop(const char*);
 
+/* JJV changed expmax (log(1.0E38)==87.49823), and added minlog */
+#define expmax 87.4982335337737
+#define infnty 1.0E38
+#define minlog 1.0E-37
 double genbet(double aa,double bb)
 /*
 **********************************************************************
@@ -30,36 +35,83 @@ double genbet(double aa,double bb)
 **********************************************************************
 */
 {
-/* JJV changed expmax (log(1.0E38)==87.49823), and added minlog */
-#define expmax 87.4982335337737
-#define infnty 1.0E38
-#define minlog 1.0E-37
-static double olda = -1.0E37;
-static double oldb = -1.0E37;
-static double genbet,a,alpha,b,beta,delta,gamma,k1,k2,r,s,t,u1,u2,v,w,y,z;
-static long qsame;
+genbet_t st;
+
+    genbet_setup(&st,aa,bb);
+    return genbet_sample(&st);
+}
+
+void genbet_setup(genbet_t *st,double aa,double bb)
+/*
+**********************************************************************
+     void genbet_setup(genbet_t *st,double aa,double bb)
+     Computes into ST the constants of Algorithm BB or BC for the
+     beta distribution with parameters AA and BB, so that
+     genbet_sample() can draw from it without any further setup
+**********************************************************************
+*/
+{
+double a,alpha,b,beta,delta;
 
-    qsame = olda == aa && oldb == bb;
-    if(qsame) goto S20;
     if(!(aa < minlog || bb < minlog)) goto S10;
     fputs(" AA or BB < 1.0E-37 in GENBET - Abort!\n",stderr);
     fprintf(stderr," AA: %16.6E BB %16.6E\n",aa,bb);
     exit(1);
 S10:
-    olda = aa;
-    oldb = bb;
-S20:
+    st->aa = aa;
+    st->bb = bb;
     if(!(min(aa,bb) > 1.0)) goto S100;
 /*
      Algorithm BB
      Initialize
 */
-    if(qsame) goto S30;
     a = min(aa,bb);
     b = max(aa,bb);
     alpha = a+b;
     beta = sqrt((alpha-2.0)/(2.0*a*b-alpha));
-    gamma = a+1.0/beta;
+    st->gamma = a+1.0/beta;
+    goto S110;
+S100:
+/*
+     Algorithm BC
+     Initialize
+*/
+    a = max(aa,bb);
+    b = min(aa,bb);
+    alpha = a+b;
+    beta = 1.0/b;
+    delta = 1.0+a-b;
+    st->k1 = delta*(1.38888888888889E-2+4.16666666666667E-2*b) /
+             (a*beta-0.777777777777778);
+    st->k2 = 0.25+(0.5+0.25/delta)*b;
+S110:
+    st->a = a;
+    st->b = b;
+    st->alpha = alpha;
+    st->beta = beta;
+}
+
+double genbet_sample(const genbet_t *st)
+/*
+**********************************************************************
+     double genbet_sample(const genbet_t *st)
+     Returns a single random deviate from the beta distribution set
+     up by genbet_setup()
+**********************************************************************
+*/
+{
+double genbet,a,aa,alpha,b,beta,gamma,k1,k2,r,s,t,u1,u2,v,w,y,z;
+
+    aa = st->aa;
+    a = st->a;
+    b = st->b;
+    alpha = st->alpha;
+    beta = st->beta;
+    if(!(min(st->aa,st->bb) > 1.0)) goto S100;
+/*
+     Algorithm BB
+*/
+    gamma = st->gamma;
 S30:
     u1 = ranf();
 /*
@@ -116,18 +168,9 @@ S70:
 S100:
 /*
      Algorithm BC
-     Initialize
 */
-    if(qsame) goto S110;
-    a = max(aa,bb);
-    b = min(aa,bb);
-    alpha = a+b;
-    beta = 1.0/b;
-    delta = 1.0+a-b;
-    k1 = delta*(1.38888888888889E-2+4.16666666666667E-2*b) /
-         (a*beta-0.777777777777778);
-    k2 = 0.25+(0.5+0.25/delta)*b;
-S110:
+    k1 = st->k1;
+    k2 = st->k2;
 S120:
     u1 = ranf();
 /*
@@ -297,7 +340,7 @@ double genexp(double av)
 **********************************************************************
 */
 {
-static double genexp;
+double genexp;
 
 /* JJV added check that av >= 0 */
     if(av >= 0.0) goto S10;
@@ -305,7 +348,7 @@ static double genexp;
     fprintf(stderr," Value of AV: %16.6E\n",av);
     exit(1);
 S10:
-    genexp = sexpo()*av;
+    genexp = rv_sexpo()*av;
     return genexp;
 }
 
@@ -441,7 +484,7 @@ static double ae;
 /*
      Generate P independent normal deviates - WORK ~ N(0,1)
 */
-    for(i=1; i<=p; i++) *(work+i-1) = snorm();
+    for(i=1; i<=p; i++) *(work+i-1) = rv_snorm();
     for(i=1,D3=1,D4=(p-i+D3)/D3; D4>0; D4--,i+=D3) {
 /*
      PARM (P+2 : P*(P+3)/2 + 1) contains A, the Cholesky
@@ -560,14 +603,14 @@ S10:
  * JJV case df == 1.0
  * gennch = pow(gennor(sqrt(xnonc),1.0),2.0); <- OLD
  */
-    gennch = pow(snorm()+sqrt(xnonc),2.0);
+    gennch = pow(rv_snorm()+sqrt(xnonc),2.0);
     goto S30;
 S20:
 /*
  * JJV case df > 1.0
  * gennch = genchi(df-1.0)+pow(gennor(sqrt(xnonc),1.0),2.0); <- OLD
  */
-    gennch = 2.0*sgamma((df-1.0)/2.0)+pow(snorm()+sqrt(xnonc),2.0);
+    gennch = 2.0*sgamma((df-1.0)/2.0)+pow(rv_snorm()+sqrt(xnonc),2.0);
 S30:
     return gennch;
 }
@@ -617,11 +660,11 @@ S10:
  */
     if(dfn >= 1.000001) goto S20;
 /* JJV case dfn == 1.0, dfn is counted as exactly 1.0 */
-    xnum = pow(snorm()+sqrt(xnonc),2.0);
+    xnum = pow(rv_snorm()+sqrt(xnonc),2.0);
     goto S30;
 S20:
 /* JJV case df > 1.0 */
-    xnum = (2.0*sgamma((dfn-1.0)/2.0)+pow(snorm()+sqrt(xnonc),2.0))/dfn;
+    xnum = (2.0*sgamma((dfn-1.0)/2.0)+pow(rv_snorm()+sqrt(xnonc),2.0))/dfn;
 S30:
     xden = 2.0*sgamma(dfd/2.0)/dfd;
 /*
@@ -669,7 +712,7 @@ double gennor(double av,double sd)
 **********************************************************************
 */
 {
-static double gennor;
+double gennor;
 
 /* JJV added argument checker */
     if(sd >= 0.0) goto S10;
@@ -677,7 +720,7 @@ static double gennor;
     fprintf(stderr," Value of SD: %16.6E\n",sd);
     exit(1);
 S10:
-    gennor = sd*snorm()+av;
+    gennor = sd*rv_snorm()+av;
     return gennor;
 }
 
@@ -716,7 +759,7 @@ double genunf(double low,double high)
 **********************************************************************
 */
 {
-static double genunf;
+double genunf;
 
     if(!(low > high)) goto S10;
     fprintf(stderr,"LOW > HIGH in GENUNF: LOW %16.6E HIGH: %16.6E\n",low,high);
@@ -893,37 +936,48 @@ long ignbin(long n,double pp)
      GGUBFS IS USED TO GENERATE UNIFORM RANDOM NUMBER, OTHERWISE
      TYPE OF ISEED SHOULD BE DICTATED BY THE UNIFORM GENERATOR
 **********************************************************************
-*****DETERMINE APPROPRIATE ALGORITHM AND WHETHER SETUP IS NECESSARY
+*****DETERMINE APPROPRIATE ALGORITHM
 */
 {
-/* JJV changed initial values to ridiculous values */
-static double psave = -1.0E37;
-static long nsave = -214748365;
-static long ignbin,i,ix,ix1,k,m,mp,T1;
-static double al,alv,amaxp,c,f,f1,f2,ffm,fm,g,p,p1,p2,p3,p4,q,qn,r,u,v,w,w2,x,x1,
-    x2,xl,xll,xlr,xm,xnp,xnpq,xr,ynorm,z,z2;
-
-    if(pp != psave) goto S10;
-    if(n != nsave) goto S20;
-    if(xnp < 30.0) goto S150;
-    goto S30;
-S10:
+ignbin_t st;
+
+    ignbin_setup(&st,n,pp);
+    return ignbin_sample(&st);
+}
+
+void ignbin_setup(ignbin_t *st,long n,double pp)
 /*
-*****SETUP, PERFORM ONLY WHEN PARAMETERS CHANGE
+**********************************************************************
+     void ignbin_setup(ignbin_t *st,long n,double pp)
+     Computes into ST the constants of the inverse cdf logic or of
+     algorithm BTPE for the binomial distribution with N trials and
+     probability PP, so that ignbin_sample() can draw from it without
+     any further setup
+**********************************************************************
+*/
+{
+double al,ffm,fm,p,p1,q,xl,xm,xnp,xnpq,xr;
+long m;
+
+/*
+*****SETUP
 JJV added checks to ensure 0.0 <= PP <= 1.0
 */
     if(pp < 0.0F) ftnstop("PP < 0.0 in IGNBIN");
     if(pp > 1.0F) ftnstop("PP > 1.0 in IGNBIN");
-    psave = pp;
-    p = min(psave,1.0-psave);
+    st->psave = pp;
+    p = min(pp,1.0-pp);
     q = 1.0-p;
-S20:
 /*
 JJV added check to ensure N >= 0
 */
     if(n < 0L) ftnstop("N < 0 in IGNBIN");
     xnp = n*p;
-    nsave = n;
+    st->n = n;
+    st->p = p;
+    st->q = q;
+    st->xnp = xnp;
+    st->r = p/q;
     if(xnp < 30.0) goto S140;
     ffm = xnp+p;
     m = ffm;
@@ -933,14 +987,66 @@ JJV added check to ensure N >= 0
     xm = fm+0.5;
     xl = xm-p1;
     xr = xm+p1;
-    c = 0.134+20.5/(15.3+fm);
+    st->m = m;
+    st->fm = fm;
+    st->xnpq = xnpq;
+    st->p1 = p1;
+    st->xm = xm;
+    st->xl = xl;
+    st->xr = xr;
+    st->c = 0.134+20.5/(15.3+fm);
     al = (ffm-xl)/(ffm-xl*p);
-    xll = al*(1.0+0.5*al);
+    st->xll = al*(1.0+0.5*al);
     al = (xr-ffm)/(xr*q);
-    xlr = al*(1.0+0.5*al);
-    p2 = p1*(1.0+c+c);
-    p3 = p2+c/xll;
-    p4 = p3+c/xlr;
+    st->xlr = al*(1.0+0.5*al);
+    st->p2 = p1*(1.0+st->c+st->c);
+    st->p3 = st->p2+st->c/st->xll;
+    st->p4 = st->p3+st->c/st->xlr;
+    st->g = (n+1)*st->r;
+    return;
+S140:
+/*
+     INVERSE CDF LOGIC FOR MEAN LESS THAN 30
+*/
+/* The following change was recommended by Paul B. to get around an
+   error when using gcc under AIX. 2006-09-12. */
+/**    qn = pow(q,(double)n); <- OLD **/
+    st->qn = exp( (double)n * log(q) );
+    st->g = st->r*(n+1);
+}
+
+long ignbin_sample(const ignbin_t *st)
+/*
+**********************************************************************
+     long ignbin_sample(const ignbin_t *st)
+     Returns a single random deviate from the binomial distribution
+     set up by ignbin_setup()
+**********************************************************************
+*/
+{
+long ignbin,i,ix,ix1,k,m,mp,n,T1;
+double alv,amaxp,c,f,f1,f2,fm,g,p,p1,p2,p3,p4,q,qn,r,u,v,w,w2,x,x1,
+    x2,xl,xll,xlr,xm,xnpq,xr,ynorm,z,z2;
+
+    n = st->n;
+    r = st->r;
+    g = st->g;
+    if(st->xnp < 30.0) goto S145;
+    p = st->p;
+    q = st->q;
+    m = st->m;
+    fm = st->fm;
+    xnpq = st->xnpq;
+    p1 = st->p1;
+    xm = st->xm;
+    xl = st->xl;
+    xr = st->xr;
+    c = st->c;
+    xll = st->xll;
+    xlr = st->xlr;
+    p2 = st->p2;
+    p3 = st->p3;
+    p4 = st->p4;
 S30:
 /*
 *****GENERATE VARIATE
@@ -989,8 +1095,6 @@ S70:
      EXPLICIT EVALUATION
 */
     f = 1.0;
-    r = p/q;
-    g = (n+1)*r;
     T1 = m-ix;
     if(T1 < 0) goto S80;
     else if(T1 == 0) goto S120;
@@ -1032,16 +1136,11 @@ S130:
       (99.0-140.0/x2)/x2)/x2)/x2)/x1/166320.0+(13860.0-(462.0-(132.0-(99.0
       -140.0/w2)/w2)/w2)/w2)/w/166320.0) goto S170;
     goto S30;
-S140:
+S145:
 /*
      INVERSE CDF LOGIC FOR MEAN LESS THAN 30
 */
-/* The following change was recommended by Paul B. to get around an
-   error when using gcc under AIX. 2006-09-12. */
-/**    qn = pow(q,(double)n); <- OLD **/
-    qn = exp( (double)n * log(q) );
-    r = p/q;
-    g = r*(n+1);
+    qn = st->qn;
 S150:
     ix = 0;
     f = qn;
@@ -1054,7 +1153,7 @@ S160:
     f *= (g/ix-r);
     goto S160;
 S170:
-    if(psave > 0.5) ix = n-ix;
+    if(st->psave > 0.5) ix = n-ix;
     ignbin = ix;
     return ignbin;
 }
@@ -1172,6 +1271,89 @@ long ignpoi(double mu)
      SEPARATION OF CASES A AND B
 */
 {
+ignpoi_t st;
+
+    ignpoi_setup(&st,mu);
+    return ignpoi_sample(&st);
+}
+
+void ignpoi_setup(ignpoi_t *st,double mu)
+/*
+**********************************************************************
+     void ignpoi_setup(ignpoi_t *st,double mu)
+     Computes into ST the constants of case A, or the whole table of
+     cumulative probabilities of case B, for the Poisson distribution
+     with mean MU, so that ignpoi_sample() can draw from it without
+     any further setup
+**********************************************************************
+*/
+{
+double b1,b2,p,q;
+long k;
+
+    st->mu = mu;
+    if(mu < 10.0) goto S120;
+/*
+     C A S E  A. (CALCULATION OF S,D,LL)
+     JJV changed l in Case A to ll
+*/
+    st->s = sqrt(mu);
+    st->d = 6.0*mu*mu;
+/*
+             THE POISSON PROBABILITIES PK EXCEED THE DISCRETE NORMAL
+             PROBABILITIES FK WHENEVER K >= M(MU). LL=IFIX(MU-1.1484)
+             IS AN UPPER BOUND TO M(MU) FOR ALL MU >= 10 .
+*/
+    st->ll = (long) (mu-1.1484);
+/*
+     STEP P. PREPARATIONS FOR STEPS Q AND H.
+             .3989423=(2*PI)**(-.5)  .416667E-1=1./24.  .1428571=1./7.
+             THE QUANTITIES B1, B2, C3, C2, C1, C0 ARE FOR THE HERMITE
+             APPROXIMATIONS TO THE DISCRETE NORMAL PROBABILITIES FK.
+             C=.1069/MU GUARANTEES MAJORIZATION BY THE 'HAT'-FUNCTION.
+*/
+    st->omega = 0.398942280401433/st->s;
+    b1 = 4.16666666666667E-2/mu;
+    b2 = 0.3*b1*b1;
+    st->c3 = 0.142857142857143*b1*b2;
+    st->c2 = b2-15.0*st->c3;
+    st->c1 = b1-6.0*b2+45.0*st->c3;
+    st->c0 = 1.0-b1+3.0*b2-15.0*st->c3;
+    st->c = 0.1069/mu;
+    return;
+S120:
+/*
+     C A S E  B. (CALCULATE P0 AND THE PP-TABLE)
+     JJV added argument checker here
+*/
+    if(mu >= 0.0) goto S125;
+    fprintf(stderr,"MU < 0 in IGNPOI: MU %16.6E\n",mu);
+    fputs("Abort\n",stderr);
+    exit(1);
+S125:
+    st->m = max(1L,(long) (mu));
+    p = exp(-mu);
+    q = st->p0 = p;
+/*
+     STEP C. CREATION OF THE POISSON PROBABILITIES P
+             AND THEIR CUMULATIVES Q=PP(K)
+*/
+    for(k=1; k<=35; k++) {
+        p = p*mu/(double)k;
+        q += p;
+        *(st->pp+k-1) = q;
+    }
+}
+
+long ignpoi_sample(const ignpoi_t *st)
+/*
+**********************************************************************
+     long ignpoi_sample(const ignpoi_t *st)
+     Returns a single random deviate from the Poisson distribution
+     set up by ignpoi_setup()
+**********************************************************************
+*/
+{
 extern double fsign( double num, double sign );
 static double a0 = -0.5;
 static double a1 =  0.3333333343;
@@ -1183,37 +1365,33 @@ static double a6 = -0.1241963125;
 static double a7 =  0.1101687109;
 static double a8 = -0.1142650302;
 static double a9 =  0.1055093006;
-/* JJV changed the initial values of MUPREV and MUOLD */
-static double muold = -1.0E37;
-static double muprev = -1.0E37;
 static double fact[10] = {
     1.0,1.0,2.0,6.0,24.0,120.0,720.0,5040.0,40320.0,362880.0
 };
 /* JJV added ll to the list, for Case A */
-static long ignpoi,j,k,kflag,l,ll,m;
-static double b1,b2,c,c0,c1,c2,c3,d,del,difmuk,e,fk,fx,fy,g,omega,p,p0,px,py,q,s,
-    t,u,v,x,xx,pp[35];
+long ignpoi,j,k,kflag,ll,m;
+double c,c0,c1,c2,c3,d,del,difmuk,e,fk,fx,fy,g,mu,omega,p0,px,py,s,
+    t,u,v,x,xx;
+const double *pp;
 
-    if(mu == muprev) goto S10;
+    mu = st->mu;
     if(mu < 10.0) goto S120;
 /*
-     C A S E  A. (RECALCULATION OF S,D,LL IF MU HAS CHANGED)
-     JJV changed l in Case A to ll
-*/
-    muprev = mu;
-    s = sqrt(mu);
-    d = 6.0*mu*mu;
-/*
-             THE POISSON PROBABILITIES PK EXCEED THE DISCRETE NORMAL
-             PROBABILITIES FK WHENEVER K >= M(MU). LL=IFIX(MU-1.1484)
-             IS AN UPPER BOUND TO M(MU) FOR ALL MU >= 10 .
+     C A S E  A.
 */
-    ll = (long) (mu-1.1484);
-S10:
+    s = st->s;
+    d = st->d;
+    ll = st->ll;
+    omega = st->omega;
+    c3 = st->c3;
+    c2 = st->c2;
+    c1 = st->c1;
+    c0 = st->c0;
+    c = st->c;
 /*
      STEP N. NORMAL SAMPLE - SNORM(IR) FOR STANDARD NORMAL DEVIATE
 */
-    g = mu+s*snorm();
+    g = mu+s*rv_snorm();
     if(g < 0.0) goto S20;
     ignpoi = (long) (g);
 /*
@@ -1228,25 +1406,6 @@ S10:
     u = ranf();
     if(d*u >= difmuk*difmuk*difmuk) return ignpoi;
 S20:
-/*
-     STEP P. PREPARATIONS FOR STEPS Q AND H.
-             (RECALCULATIONS OF PARAMETERS IF NECESSARY)
-             .3989423=(2*PI)**(-.5)  .416667E-1=1./24.  .1428571=1./7.
-             THE QUANTITIES B1, B2, C3, C2, C1, C0 ARE FOR THE HERMITE
-             APPROXIMATIONS TO THE DISCRETE NORMAL PROBABILITIES FK.
-             C=.1069/MU GUARANTEES MAJORIZATION BY THE 'HAT'-FUNCTION.
-*/
-    if(mu == muold) goto S30;
-    muold = mu;
-    omega = 0.398942280401433/s;
-    b1 = 4.16666666666667E-2/mu;
-    b2 = 0.3*b1*b1;
-    c3 = 0.142857142857143*b1*b2;
-    c2 = b2-15.0*c3;
-    c1 = b1-6.0*b2+45.0*c3;
-    c0 = 1.0-b1+3.0*b2-15.0*c3;
-    c = 0.1069/mu;
-S30:
     if(g < 0.0) goto S50;
 /*
              'SUBROUTINE' F IS CALLED (KFLAG=0 FOR CORRECT RETURN)
@@ -1264,7 +1423,7 @@ S50:
              DEVIATE E AND SAMPLE T FROM THE LAPLACE 'HAT'
              (IF T <= -.6744 THEN PK < FK FOR ALL MU >= 10.)
 */
-    e = sexpo();
+    e = rv_sexpo();
     u = ranf();
     u += (u-1.0);
     t = 1.8+fsign(e,u);
@@ -1317,22 +1476,11 @@ S110:
     goto S60;
 S120:
 /*
-     C A S E  B. (START NEW TABLE AND CALCULATE P0 IF NECESSARY)
-     JJV changed MUPREV assignment to initial value
+     C A S E  B.
 */
-    muprev = -1.0E37;
-    if(mu == muold) goto S130;
-/* JJV added argument checker here */
-    if(mu >= 0.0) goto S125;
-    fprintf(stderr,"MU < 0 in IGNPOI: MU %16.6E\n",mu);
-    fputs("Abort\n",stderr);
-    exit(1);
-S125:
-    muold = mu;
-    m = max(1L,(long) (mu));
-    l = 0;
-    p = exp(-mu);
-    q = p0 = p;
+    m = st->m;
+    p0 = st->p0;
+    pp = st->pp;
 S130:
 /*
      STEP U. UNIFORM SAMPLE FOR INVERSION METHOD
@@ -1341,33 +1489,16 @@ S130:
     ignpoi = 0;
     if(u <= p0) return ignpoi;
 /*
-     STEP T. TABLE COMPARISON UNTIL THE END PP(L) OF THE
+     STEP T. TABLE COMPARISON UNTIL THE END PP(35) OF THE
              PP-TABLE OF CUMULATIVE POISSON PROBABILITIES
              (0.458=PP(9) FOR MU=10)
 */
-    if(l == 0) goto S150;
     j = 1;
-    if(u > 0.458) j = min(l,m);
-    for(k=j; k<=l; k++) {
+    if(u > 0.458) j = min(35L,m);
+    for(k=j; k<=35; k++) {
         if(u <= *(pp+k-1)) goto S180;
     }
-    if(l == 35) goto S130;
-S150:
-/*
-     STEP C. CREATION OF NEW POISSON PROBABILITIES P
-             AND THEIR CUMULATIVES Q=PP(K)
-*/
-    l += 1;
-    for(k=l; k<=35; k++) {
-        p = p*mu/(double)k;
-        q += p;
-        *(pp+k-1) = q;
-        if(u <= q) goto S170;
-    }
-    l = 35;
     goto S130;
-S170:
-    l = k;
 S180:
     ignpoi = k;
     return ignpoi;
@@ -1730,9 +1861,9 @@ static double q[8] = {
     0.69314718055995, 0.93337368751905, 0.98887779618387, 0.99849592529150,
     0.99982928110614, 0.99998331641007, 0.99999856914388, 0.99999989069256
 };
-static long i;
-static double sexpo,a,u,ustar,umin;
-static double *q1 = q;
+long i;
+double sexpo,a,u,ustar,umin;
+double *q1 = q;
     a = 0.0;
     u = ranf();
     goto S30;
@@ -1816,7 +1947,22 @@ double sgamma(double a)
      SQRT32 IS THE SQUAREROOT OF 32 = 5.656854249492380
 */
 {
-extern double fsign( double num, double sign );
+sgamma_t st;
+
+    sgamma_setup(&st,a);
+    return sgamma_sample(&st);
+}
+void sgamma_setup(sgamma_t *st,double a)
+/*
+**********************************************************************
+     void sgamma_setup(sgamma_t *st,double a)
+     Computes into ST the constants of steps 1 and 4 for A >= 1.0, or
+     B0 for A < 1.0, so that sgamma_sample() can draw from the
+     standard gamma distribution of parameter A without any further
+     setup
+**********************************************************************
+*/
+{
 static double q1 = 4.16666664E-2;
 static double q2 = 2.08333723E-2;
 static double q3 = 7.9849875E-3;
@@ -1826,6 +1972,70 @@ static double q6 = 3.340332E-4;
 static double q7 = 6.053049E-4;
 static double q8 = -4.701849E-4;
 static double q9 = 1.710320E-4;
+static double sqrt32 = 5.65685424949238;
+double r;
+
+    st->a = a;
+    st->s2 = st->s = st->d = st->q0 = st->b = st->si = st->c = st->b0 = 0.0;
+    if(a < 1.0) goto S120;
+/*
+     STEP  1:  RECALCULATIONS OF S2,S,D IF A HAS CHANGED
+*/
+    st->s2 = a-0.5;
+    st->s = sqrt(st->s2);
+    st->d = sqrt32-12.0*st->s;
+/*
+     STEP  4:  RECALCULATIONS OF Q0,B,SI,C IF NECESSARY
+*/
+    r = 1.0/a;
+    st->q0 = ((((((((q9*r+q8)*r+q7)*r+q6)*r+q5)*r+q4)*r+q3)*r+q2)*r+q1)*r;
+/*
+               APPROXIMATION DEPENDING ON SIZE OF PARAMETER A
+               THE CONSTANTS IN THE EXPRESSIONS FOR B, SI AND
+               C WERE ESTABLISHED BY NUMERICAL EXPERIMENTS
+*/
+    if(a <= 3.686) goto S30;
+    if(a <= 13.022) goto S20;
+/*
+               CASE 3:  A .GT. 13.022
+*/
+    st->b = 1.77;
+    st->si = 0.75;
+    st->c = 0.1515/st->s;
+    return;
+S20:
+/*
+               CASE 2:  3.686 .LT. A .LE. 13.022
+*/
+    st->b = 1.654+7.6E-3*st->s2;
+    st->si = 1.68/st->s+0.275;
+    st->c = 6.2E-2/st->s+2.4E-2;
+    return;
+S30:
+/*
+               CASE 1:  A .LE. 3.686
+*/
+    st->b = 0.463+st->s+0.178*st->s2;
+    st->si = 1.235;
+    st->c = 0.195/st->s-7.9E-2+1.6E-1*st->s;
+    return;
+S120:
+/*
+     ALTERNATE METHOD FOR PARAMETERS A BELOW 1  (.3678794=EXP(-1.))
+*/
+    st->b0 = 1.0+ 0.3678794411714423*a;
+}
+double sgamma_sample(const sgamma_t *st)
+/*
+**********************************************************************
+     double sgamma_sample(const sgamma_t *st)
+     A sample from the standard gamma distribution set up into ST by
+     sgamma_setup(), the steps being those of sgamma() but for the
+     setup ones
+**********************************************************************
+*/
+{
+extern double fsign( double num, double sign );
 static double a1 =  0.333333333;
 static double a2 = -0.249999949;
 static double a3 =  0.199999867;
@@ -1842,27 +2052,17 @@ static double e4 = 4.1664508E-2;
 static double e5 = 8.345522E-3;
 static double e6 = 1.353826E-3;
 static double e7 = 2.47453E-4;
-static double aa = 0.0;
-static double aaa = 0.0;
-static double sqrt32 = 5.65685424949238;
-/* JJV added b0 to fix rare and subtle bug */
-static double sgamma,s2,s,d,t,x,u,r,q0,b,b0,si,c,v,q,e,w,p;
-    if(a == aa) goto S10;
-    if(a < 1.0) goto S120;
-/*
-     STEP  1:  RECALCULATIONS OF S2,S,D IF A HAS CHANGED
-*/
-    aa = a;
-    s2 = a-0.5;
-    s = sqrt(s2);
-    d = sqrt32-12.0*s;
-S10:
+double a = st->a,s2 = st->s2,s = st->s,d = st->d;
+double q0 = st->q0,b = st->b,si = st->si,c = st->c,b0 = st->b0;
+double sgamma,t,x,u,v,q,e,w,p;
+
+    if(a < 1.0) goto S130;
 /*
      STEP  2:  T=STANDARD NORMAL DEVIATE,
                X=(S,1/2)-NORMAL DEVIATE.
                IMMEDIATE ACCEPTANCE (I)
 */
-    t = snorm();
+    t = rv_snorm();
     x = s+0.5*t;
     sgamma = x*x;
     if(t >= 0.0) return sgamma;
@@ -1871,43 +2071,6 @@ S10:
 */
     u = ranf();
     if(d*u <= t*t*t) return sgamma;
-/*
-     STEP  4:  RECALCULATIONS OF Q0,B,SI,C IF NECESSARY
-*/
-    if(a == aaa) goto S40;
-    aaa = a;
-    r = 1.0/a;
-    q0 = ((((((((q9*r+q8)*r+q7)*r+q6)*r+q5)*r+q4)*r+q3)*r+q2)*r+q1)*r;
-/*
-               APPROXIMATION DEPENDING ON SIZE OF PARAMETER A
-               THE CONSTANTS IN THE EXPRESSIONS FOR B, SI AND
-               C WERE ESTABLISHED BY NUMERICAL EXPERIMENTS
-*/
-    if(a <= 3.686) goto S30;
-    if(a <= 13.022) goto S20;
-/*
-               CASE 3:  A .GT. 13.022
-*/
-    b = 1.77;
-    si = 0.75;
-    c = 0.1515/s;
-    goto S40;
-S20:
-/*
-               CASE 2:  3.686 .LT. A .LE. 13.022
-*/
-    b = 1.654+7.6E-3*s2;
-    si = 1.68/s+0.275;
-    c = 6.2E-2/s+2.4E-2;
-    goto S40;
-S30:
-/*
-               CASE 1:  A .LE. 3.686
-*/
-    b = 0.463+s+0.178*s2;
-    si = 1.235;
-    c = 0.195/s-7.9E-2+1.6E-1*s;
-S40:
 /*
      STEP  5:  NO QUOTIENT TEST IF X NOT POSITIVE
 */
@@ -1932,7 +2095,7 @@ S70:
                U= 0,1 -UNIFORM DEVIATE
                T=(B,SI)-DOUBLE EXPONENTIAL (LAPLACE) SAMPLE
 */
-    e = sexpo();
+    e = rv_sexpo();
     u = ranf();
     u += (u-1.0);
     t = b+fsign(si*e,u);
@@ -1982,7 +2145,7 @@ S115:
     x = s+0.5*t;
     sgamma = x*x;
     return sgamma;
-S120:
+S130:
 /*
      ALTERNATE METHOD FOR PARAMETERS A BELOW 1  (.3678794=EXP(-1.))
 
@@ -1994,18 +2157,15 @@ S120:
      JJV The A < 1.0 case (here) no longer changes any of these, and
      JJV the recalculation of B (which used to change with an
      JJV A < 1.0 call) is governed by the state of AAA anyway.
-    aa = 0.0;
 */
-    b0 = 1.0+ 0.3678794411714423*a;
-S130:
     p = b0*ranf();
     if(p >= 1.0) goto S140;
     sgamma = exp(log(p)/ a);
-    if(sexpo() < sgamma) goto S130;
+    if(rv_sexpo() < sgamma) goto S130;
     return sgamma;
 S140:
     sgamma = -log((b0-p)/ a);
-    if(sexpo() < (1.0-a)*log(sgamma)) goto S130;
+    if(rv_sexpo() < (1.0-a)*log(sgamma)) goto S130;
     return sgamma;
 }
 
@@ -2078,8 +2238,8 @@ static double h[31] = {
     8.781922325338E-2, 9.930398323927E-2, 0.11555994154118,  0.14043438342816,
     0.18361418337460,  0.27900163464163,  0.70104742502766
 };
-static long i;
-static double snorm,u,s,ustar,aa,w,y,tt;
+long i;
+double snorm,u,s,ustar,aa,w,y,tt;
     u = ranf();
     s = 0.0;
     if(u > 0.5) s = 1.0;
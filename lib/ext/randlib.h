@@ -1,10 +1,43 @@
 #ifndef __RANDLIB_H_
 #define __RANDLIB_H_
 
+/* Setup of the samplers whose constants depend on their parameters only,
+   computed once by the *_setup() routines and then only read by the
+   *_sample() ones */
+typedef struct {
+    double aa,bb,a,b,alpha,beta,gamma,k1,k2;
+} genbet_t;
+
+typedef struct {
+    long n,m;
+    double psave,p,q,xnp,r,g,qn;
+    double fm,xnpq,p1,xm,xl,xr,c,xll,xlr,p2,p3,p4;
+} ignbin_t;
+
+typedef struct {
+    double mu;
+    /* case A, mu >= 10 */
+    double s,d,omega,c,c0,c1,c2,c3;
+    long ll;
+    /* case B, mu < 10 */
+    long m;
+    double p0,pp[35];
+} ignpoi_t;
+
+typedef struct {
+    double a;
+    /* a >= 1.0 */
+    double s2,s,d,q0,b,si,c;
+    /* a < 1.0 */
+    double b0;
+} sgamma_t;
+
 /* Prototypes for all user accessible RANDLIB routines */
 
 extern void advnst(long k);
 extern double genbet(double aa,double bb);
+extern void genbet_setup(genbet_t *st,double aa,double bb);
+extern double genbet_sample(const genbet_t *st);
 extern double genchi(double df);
 extern double genexp(double av);
 extern double genf(double dfn, double dfd);
@@ -19,9 +52,13 @@ extern double genunf(double low,double high);
 extern void getsd(long *iseed1,long *iseed2);
 extern void gscgn(long getset,long *g);
 extern long ignbin(long n,double pp);
+extern void ignbin_setup(ignbin_t *st,long n,double pp);
+extern long ignbin_sample(const ignbin_t *st);
 extern long ignnbn(long n,double p);
 extern long ignlgi(void);
 extern long ignpoi(double mu);
+extern void ignpoi_setup(ignpoi_t *st,double mu);
+extern long ignpoi_sample(const ignpoi_t *st);
 extern long ignuin(long low,long high);
 extern void initgn(long isdtyp);
 extern long mltmod(long a,long s,long m);
@@ -33,6 +70,8 @@ extern void setgmn(double *meanv,double *covm,long p,double *parm);
 extern void setsd(long iseed1,long iseed2);
 extern double sexpo(void);
 extern double sgamma(double a);
+extern void sgamma_setup(sgamma_t *st,double a);
+extern double sgamma_sample(const sgamma_t *st);
 extern double snorm(void);
 
 #endif /* __RANDLIB_H_ */
@@ -55,9 +55,33 @@
 #error "No limits.h header found"
 #endif /* HAVE_LIMITS_H */
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
+
+#ifdef HAVE_RUBY_THREAD_H
+#include <ruby/thread.h>
+#endif /* HAVE_RUBY_THREAD_H */
+
+#ifdef HAVE_RUBY_IO_BUFFER_H
+#include <ruby/io/buffer.h>
+#endif /* HAVE_RUBY_IO_BUFFER_H */
+
+#include <ruby/encoding.h>
+#include <string.h>
+#include <stdint.h>
+
 #include "gen.h"
+#include "alias.h"
+#include "expr.h"
 #include "randlib.h"
 #include "xrandlib.h"
+#include "ziggurat.h"
+#include "samples.h"
 
 /******************************************************************************/
 /* random variable types */
@@ -68,11 +92,16 @@ typedef enum {
 	rv_type_bernoulli,
 	rv_type_beta,
 	rv_type_binomial,
+	rv_type_categorical,
 	rv_type_chi_squared,
 	rv_type_continuous_uniform,
 	rv_type_discrete_uniform,
 	rv_type_exponential,
+	rv_type_expression,
 	rv_type_f,
+	rv_type_gamma,
+	rv_type_mixture,
+	rv_type_multivariate_normal,
 	rv_type_negative_binomial,
 	rv_type_normal,
 	rv_type_pareto,
@@ -88,33 +117,104 @@ typedef enum {
 #define NR_RANDOM_VARIABLES	RV_NR_TYPES
 /******************************************************************************/
 
+/******************************************************************************/
+/* native type of the outcomes */
+/******************************************************************************/
+typedef enum {
+	rv_kind_double = 0,
+	rv_kind_long
+} kind_t;
+#define KIND_SIZE(kind)							\
+	((rv_kind_double == (kind)) ? sizeof(double) : sizeof(long))
+/******************************************************************************/
+
 #define RANDVAR_DATA	data
+typedef struct randvar randvar_t;
+typedef struct program program_t;
+
+/* an operand of an expression, either a random variable or a number */
+typedef struct {
+	VALUE rb_obj;
+	randvar_t *rv;		/* NULL for a number */
+	kind_t kind;
+	rv_value_t value;	/* the number */
+} operand_t;
+
+/* a standard Gamma sampler set up for either algorithm */
 typedef struct {
+	sgamma_t classic;
+	gen_gamma_t fast;
+} gamma_setup_t;
+
+struct randvar {
 	type_t type;
 #define RANDVAR_TYPE(rv)	((rv)->type)
 
+	/* the native type of its outcomes and whether it can be sampled
+	   concurrently, as given by its type unless it is an expression */
+	kind_t kind;
+#define RANDVAR_KIND(rv)	((rv)->kind)
+	int reentrant;
+#define RANDVAR_REENTRANT(rv)	((rv)->reentrant)
+
+	/* generator the outcomes are drawn from, NULL for the default one */
+	rv_gen_t *gen;
+	VALUE rb_gen;
+#define RANDVAR_GEN(rv)		((rv)->gen)
+
 	union {
-		struct { double p; } bernoulli;
-		struct { double alpha, beta; } beta;
-		struct { long n; double p; } binomial;
-		struct { long k; } chi_squared;
+		struct {
+			double p;
+			uint64_t threshold;	/* p scaled by 2^64 */
+			int low;		/* its lowest bit set */
+		} bernoulli;
+		struct {
+			double alpha, beta;
+			genbet_t setup;
+			gen_gamma_t gamma_alpha, gamma_beta;
+		} beta;
+		struct { long n; double p; ignbin_t setup; } binomial;
+		struct { rv_alias_t *table; VALUE rb_values; } categorical;
+		struct { long k; gamma_setup_t setup; } chi_squared;
 		struct { double a,b; } continuous_uniform;
 		struct { long a,b; } discrete_uniform;
 		struct { double mean; } exponential;
-		struct { double d1, d2; } f;
+		struct {
+			rv_op_t op;
+			operand_t left, right;
+			program_t *program;	/* NULL until evaluated */
+		} expression;
+		struct {
+			double d1, d2;
+			gamma_setup_t setup_d1, setup_d2;
+		} f;
+		struct { double shape, scale; gamma_setup_t setup; } gamma;
+		struct {
+			rv_alias_t *table;	/* of the components */
+			randvar_t **components;
+			VALUE rb_components;
+		} mixture;
+		struct {
+			long p;
+			double *parm;	/* the mean and the Cholesky factor */
+		} multivariate_normal;
 		struct { long r; double p; } negative_binomial;
 		struct { double mu, sigma; } normal;
 		struct { double a, m; } pareto;
-		struct { double mean; } poisson;
+		struct {
+			double mean;
+			ignpoi_t setup;
+			gen_poisson_ptrs_t ptrs;	/* for big means */
+		} poisson;
 		struct { /* no params */ } rademacher;
 		struct { double sigma; } rayleigh;
 		struct { /* no params */ } rectangular;
 	} RANDVAR_DATA;	/* union */
-} randvar_t;
+};
 #define RANDVAR_ALLOC()		ALLOC(randvar_t)
 
 #define RV_NR_PARAMS(name, nr_params)					\
-	static const int rv_ ##name ##_nr_params = nr_params;
+	enum { rv_ ##name ##_nr_params = nr_params };
 
 #define CREATE_RANDVAR_ACCESSOR(name, param, type)			\
 	static inline type 						\
@@ -150,6 +250,15 @@ typedef struct {
 				randvar_##name ##_ ##param2(rv) ); 	\
 	}
 
+/* by means of a sampler set up once, at instantiation */
+#define RANDVAR_SETUP(rv, name)	(&(rv)->RANDVAR_DATA . name . setup)
+#define CREATE_RANDVAR_OUTCOME_SETUP(name, func, type)			\
+	static inline type						\
+	randvar_##name ##_ ##outcome(randvar_t *rv)			\
+	{								\
+		return func(RANDVAR_SETUP(rv, name));			\
+	}
+
 #define CREATE_RANDVAR_RB_OUTCOME(name, conv)				\
 	static VALUE							\
 	randvar_##name ##_rb_ ##outcome(randvar_t *rv)			\
@@ -157,6 +266,103 @@ typedef struct {
 		return 	conv((randvar_##name ##_outcome(rv)));		\
 	}								\
 
+/* several outcomes at once into a native buffer of doubles or longs */
+#define CREATE_RANDVAR_FILL(name, type)					\
+	static const kind_t rv_ ##name ##_kind = rv_kind_ ##type;	\
+	static void							\
+	randvar_##name ##_fill(randvar_t *rv, void *buf, long nr)	\
+	{								\
+		type *outcomes = buf;					\
+		long i;							\
+		for (i = 0; i < nr; i++)				\
+			outcomes[i] = randvar_##name ##_outcome(rv);	\
+	}
+
+/* the same by means of a sampler producing several outcomes at once */
+#define CREATE_RANDVAR_BULK_FILL2(name, func, type, param1, param2)	\
+	static const kind_t rv_ ##name ##_kind = rv_kind_ ##type;	\
+	static void							\
+	randvar_##name ##_fill(randvar_t *rv, void *buf, long nr)	\
+	{								\
+		func(	randvar_##name ##_ ##param1(rv),		\
+			randvar_##name ##_ ##param2(rv),		\
+			(type *) buf, nr);				\
+	}
+
+/* whether the sampler may run concurrently in several native threads */
+#define RV_REENTRANT(name, flag)					\
+	enum { rv_ ##name ##_reentrant = flag };
+
+
+/* Gamma by means of the algorithm currently selected */
+static inline void gamma_setup(gamma_setup_t *st, double shape)
+{
+	sgamma_setup(&st->classic, shape);
+	gen_gamma_setup(&st->fast, shape);
+}
+
+static inline double gamma_sample(const gamma_setup_t *st)
+{
+	if (rv_algorithm_classic == rv_algorithm)
+		return sgamma_sample(&st->classic);
+	return gen_gamma(&st->fast);
+}
+
+/* 64 outcomes at once out of the bits of the generator, bit i being set
+   for a success or a +1 */
+static inline uint64_t rademacher_word(rv_gen_t *gen)
+{
+	return rv_gen_next(gen);
+}
+
+/* the 64 uniform deviates u_i are compared to the threshold t a bit at a
+   time from the most significant one on, a random word supplying the
+   next bit of every u_i: u_i < t is settled at the first bit in which
+   they differ, which takes a couple of words per 64 outcomes on average,
+   a single one for p = 0.5; an u_i equal to t so far is not lower than it
+   once the remaining bits of t are zero */
+static inline uint64_t bernoulli_word(uint64_t t, int low, rv_gen_t *gen)
+{
+	uint64_t undecided = ~UINT64_C(0), success = 0, r;
+	int k;
+
+	for (k = 63; k >= low && 0 != undecided; k--) {
+		r = rv_gen_next(gen);
+		if ((t >> k) & 1) {
+			success |= undecided & ~r;
+			undecided &= r;
+		} else {
+			undecided &= ~r;
+		}
+	}
+	return success;
+}
+
+/* several outcomes out of such words, but for the classic algorithm,
+   which takes a uniform deviate per outcome */
+#define CREATE_RANDVAR_BITS_FILL(name, word, one, zero)			\
+	static const kind_t rv_ ##name ##_kind = rv_kind_long;		\
+	static void							\
+	randvar_##name ##_fill(randvar_t *rv, void *buf, long nr)	\
+	{								\
+		long *outcomes = buf;					\
+		rv_gen_t *gen;						\
+		uint64_t w;						\
+		long i, j;						\
+		if (rv_algorithm_classic == rv_algorithm) {		\
+			for (i = 0; i < nr; i++)			\
+				outcomes[i] = 				\
+					randvar_##name ##_outcome(rv);	\
+			return;						\
+		}							\
+		gen = rv_gen_current();					\
+		for (i = 0; i < nr; i += 64) {				\
+			w = (word);					\
+			for (j = 0; j < 64 && i + j < nr; j++)		\
+				outcomes[i + j] = 			\
+					((w >> j) & 1) ? (one) : (zero);\
+		}							\
+	}
 
 /* generic */
 RV_NR_PARAMS(generic, 1)
@@ -165,93 +371,211 @@ RV_NR_PARAMS(bernoulli, 1)
 CREATE_RANDVAR_ACCESSOR(bernoulli, p, double)
 CREATE_RANDVAR_OUTCOME_FUNC1(bernoulli, gen_bernoulli, int, p)
 CREATE_RANDVAR_RB_OUTCOME(bernoulli, INT2NUM)
+CREATE_RANDVAR_BITS_FILL(bernoulli, bernoulli_word(
+	rv->RANDVAR_DATA.bernoulli.threshold, 
+	rv->RANDVAR_DATA.bernoulli.low, gen), 1, 0)
+RV_REENTRANT(bernoulli, 1)
 /* beta */
 RV_NR_PARAMS(beta, 2)
 CREATE_RANDVAR_ACCESSOR(beta, alpha, double)
 CREATE_RANDVAR_ACCESSOR(beta, beta, double)
-CREATE_RANDVAR_OUTCOME_FUNC2(beta, genbet, double, alpha, beta)
+/* as the ratio of two Gamma outcomes, but for shapes below one, which are
+   better dealt with by Cheng's algorithm */
+#define BETA_BY_GAMMA(rv)						\
+	(randvar_beta_alpha(rv) >= 1.0 && randvar_beta_beta(rv) >= 1.0)
+#define BETA_GAMMA(rv, param)	(&(rv)->RANDVAR_DATA.beta.gamma_ ##param)
+static inline double randvar_beta_outcome(randvar_t *rv)
+{
+	double x, y;
+
+	if (rv_algorithm_classic == rv_algorithm || !BETA_BY_GAMMA(rv))
+		return genbet_sample(RANDVAR_SETUP(rv, beta));
+	x = gen_gamma(BETA_GAMMA(rv, alpha));
+	y = gen_gamma(BETA_GAMMA(rv, beta));
+	return x / (x + y);
+}
 CREATE_RANDVAR_RB_OUTCOME(beta, DBL2NUM)
+CREATE_RANDVAR_FILL(beta, double)
+RV_REENTRANT(beta, 1)
 /* binomial */
 RV_NR_PARAMS(binomial, 2)
 CREATE_RANDVAR_ACCESSOR(binomial, n, long)
 CREATE_RANDVAR_ACCESSOR(binomial, p, double)
-CREATE_RANDVAR_OUTCOME_FUNC2(binomial, ignbin, long, n, p)
+CREATE_RANDVAR_OUTCOME_SETUP(binomial, ignbin_sample, long)
 CREATE_RANDVAR_RB_OUTCOME(binomial, LONG2NUM)
+CREATE_RANDVAR_FILL(binomial, long)
+RV_REENTRANT(binomial, 1)
+/* categorical */
+RV_NR_PARAMS(categorical, 2)
+CREATE_RANDVAR_ACCESSOR(categorical, table, rv_alias_t *)
+CREATE_RANDVAR_ACCESSOR(categorical, rb_values, VALUE)
+static inline long randvar_categorical_outcome(randvar_t *rv)
+{
+	return rv_alias_draw(randvar_categorical_table(rv), rv_gen_current());
+}
+/* the value of category i, i itself if no values were given */
+static inline VALUE randvar_categorical_value(randvar_t *rv, long i)
+{
+	VALUE rb_values = randvar_categorical_rb_values(rv);
+
+	return NIL_P(rb_values) ? LONG2NUM(i) : rb_ary_entry(rb_values, i);
+}
+static VALUE randvar_categorical_rb_outcome(randvar_t *rv)
+{
+	return randvar_categorical_value(rv, randvar_categorical_outcome(rv));
+}
+static const kind_t rv_categorical_kind = rv_kind_long;
+static void randvar_categorical_fill(randvar_t *rv, void *buf, long nr)
+{
+	const rv_alias_t *table = randvar_categorical_table(rv);
+	rv_gen_t *gen = rv_gen_current();
+	long *outcomes = buf;
+	long i;
+
+	for (i = 0; i < nr; i++)
+		outcomes[i] = rv_alias_draw(table, gen);
+}
+RV_REENTRANT(categorical, 1)
 /* chi-squared */
 RV_NR_PARAMS(chi_squared, 1)
 CREATE_RANDVAR_ACCESSOR(chi_squared, k, long)
-CREATE_RANDVAR_OUTCOME_FUNC1(chi_squared, gen_chi_squared, double, k)
+static inline double randvar_chi_squared_outcome(randvar_t *rv)
+{
+	return 2.0 * gamma_sample(RANDVAR_SETUP(rv, chi_squared));
+}
 CREATE_RANDVAR_RB_OUTCOME(chi_squared, DBL2NUM)
+CREATE_RANDVAR_FILL(chi_squared, double)
+RV_REENTRANT(chi_squared, 1)
 /* continuous uniform */
 RV_NR_PARAMS(continuous_uniform, 2)
 CREATE_RANDVAR_ACCESSOR(continuous_uniform, a, double)
 CREATE_RANDVAR_ACCESSOR(continuous_uniform, b, double)
 CREATE_RANDVAR_OUTCOME_FUNC2(continuous_uniform, genunf, double, a, b)
 CREATE_RANDVAR_RB_OUTCOME(continuous_uniform, DBL2NUM)
+CREATE_RANDVAR_FILL(continuous_uniform, double)
+RV_REENTRANT(continuous_uniform, 1)
 /* discrete uniform */
 RV_NR_PARAMS(discrete_uniform, 2)
 CREATE_RANDVAR_ACCESSOR(discrete_uniform, a, long)
 CREATE_RANDVAR_ACCESSOR(discrete_uniform, b, long)
 CREATE_RANDVAR_OUTCOME_FUNC2(discrete_uniform, gen_discrete_uniform, long, a, b)
 CREATE_RANDVAR_RB_OUTCOME(discrete_uniform, LONG2NUM)
+CREATE_RANDVAR_BULK_FILL2(discrete_uniform, gen_discrete_uniform_fill, long,
+								a, b)
+RV_REENTRANT(discrete_uniform, 1)
 /* exponential */
 RV_NR_PARAMS(exponential, 1)
 CREATE_RANDVAR_ACCESSOR(exponential, mean, double)
 CREATE_RANDVAR_OUTCOME_FUNC1(exponential, genexp , double, mean)
 CREATE_RANDVAR_RB_OUTCOME(exponential, DBL2NUM)
+CREATE_RANDVAR_FILL(exponential, double)
+RV_REENTRANT(exponential, 1)
 /* f */
 RV_NR_PARAMS(f, 2)
 CREATE_RANDVAR_ACCESSOR(f, d1, double)
 CREATE_RANDVAR_ACCESSOR(f, d2, double)
-CREATE_RANDVAR_OUTCOME_FUNC2(f, genf, double, d1, d2)
+static inline double randvar_f_outcome(randvar_t *rv)
+{
+	double num, den;
+
+	num = 2.0 * gamma_sample(&rv->RANDVAR_DATA.f.setup_d1) / 
+		randvar_f_d1(rv);
+	den = 2.0 * gamma_sample(&rv->RANDVAR_DATA.f.setup_d2) /
+		randvar_f_d2(rv);
+
+	/* as randlib's genf() does, short of its warning */
+	if (rv_algorithm_classic == rv_algorithm && den <= 1.0E-37 * num)
+		return 1.0E37;
+	return num / den;
+}
 CREATE_RANDVAR_RB_OUTCOME(f, DBL2NUM)
+CREATE_RANDVAR_FILL(f, double)
+RV_REENTRANT(f, 1)
+/* gamma */
+RV_NR_PARAMS(gamma, 2)
+CREATE_RANDVAR_ACCESSOR(gamma, shape, double)
+CREATE_RANDVAR_ACCESSOR(gamma, scale, double)
+static inline double randvar_gamma_outcome(randvar_t *rv)
+{
+	return randvar_gamma_scale(rv) * 
+		gamma_sample(RANDVAR_SETUP(rv, gamma));
+}
+CREATE_RANDVAR_RB_OUTCOME(gamma, DBL2NUM)
+CREATE_RANDVAR_FILL(gamma, double)
+RV_REENTRANT(gamma, 1)
 /* negative binomial */
 RV_NR_PARAMS(negative_binomial, 2)
 CREATE_RANDVAR_ACCESSOR(negative_binomial, r, long)
 CREATE_RANDVAR_ACCESSOR(negative_binomial, p, double)
 CREATE_RANDVAR_OUTCOME_FUNC2(negative_binomial, ignnbn, long, r, p)
 CREATE_RANDVAR_RB_OUTCOME(negative_binomial, LONG2NUM)
+CREATE_RANDVAR_FILL(negative_binomial, long)
+RV_REENTRANT(negative_binomial, 0)
 /* normal */
 RV_NR_PARAMS(normal, 2)
 CREATE_RANDVAR_ACCESSOR(normal, mu, double)
 CREATE_RANDVAR_ACCESSOR(normal, sigma, double)
 CREATE_RANDVAR_OUTCOME_FUNC2(normal, gennor, double, mu, sigma)
 CREATE_RANDVAR_RB_OUTCOME(normal, DBL2NUM)
+CREATE_RANDVAR_FILL(normal, double)
+RV_REENTRANT(normal, 1)
 /* pareto */
 RV_NR_PARAMS(pareto, 2)
 CREATE_RANDVAR_ACCESSOR(pareto, a, double)
 CREATE_RANDVAR_ACCESSOR(pareto, m, double)
 CREATE_RANDVAR_OUTCOME_FUNC2(pareto, gen_pareto, double, a, m)
 CREATE_RANDVAR_RB_OUTCOME(pareto, DBL2NUM)
+CREATE_RANDVAR_FILL(pareto, double)
+RV_REENTRANT(pareto, 1)
 /* poisson */
 RV_NR_PARAMS(poisson, 1)
 CREATE_RANDVAR_ACCESSOR(poisson, mean, double)
-CREATE_RANDVAR_OUTCOME_FUNC1(poisson, ignpoi, long, mean)
+/* transformed rejection is exact and takes constant expected time, the
+   classic algorithm is kept for small means */
+#define POISSON_PTRS_MIN	20.0
+static inline long randvar_poisson_outcome(randvar_t *rv)
+{
+	if (rv_algorithm_fast == rv_algorithm && 
+		randvar_poisson_mean(rv) >= POISSON_PTRS_MIN)
+		return gen_poisson_ptrs(&rv->RANDVAR_DATA.poisson.ptrs);
+	return ignpoi_sample(RANDVAR_SETUP(rv, poisson));
+}
 CREATE_RANDVAR_RB_OUTCOME(poisson, LONG2NUM)
+CREATE_RANDVAR_FILL(poisson, long)
+RV_REENTRANT(poisson, 1)
 /* rademacher */
 RV_NR_PARAMS(rademacher, 0)
 CREATE_RANDVAR_OUTCOME_FUNC0(rademacher, gen_rademacher, int)
 CREATE_RANDVAR_RB_OUTCOME(rademacher, INT2FIX)
+CREATE_RANDVAR_BITS_FILL(rademacher, rademacher_word(gen), 1, -1)
+RV_REENTRANT(rademacher, 1)
 /* rayleigh */
 RV_NR_PARAMS(rayleigh, 1)
 CREATE_RANDVAR_ACCESSOR(rayleigh, sigma, double)
 CREATE_RANDVAR_OUTCOME_FUNC1(rayleigh, gen_rayleigh, double, sigma)
 CREATE_RANDVAR_RB_OUTCOME(rayleigh, DBL2NUM)
+CREATE_RANDVAR_FILL(rayleigh, double)
+RV_REENTRANT(rayleigh, 1)
 /* rectangular */
 RV_NR_PARAMS(rectangular, 0)
 CREATE_RANDVAR_OUTCOME_FUNC0(rectangular, gen_rectangular, double)
 CREATE_RANDVAR_RB_OUTCOME(rectangular, DBL2NUM)
+CREATE_RANDVAR_FILL(rectangular, double)
+RV_REENTRANT(rectangular, 1)
 
 /******************************************************************************/
 /* class and module objects */
 static VALUE rb_mRandomVariable;
-static VALUE rb_mGenerator;
+static VALUE rb_cGenerator;
 static VALUE rb_cRandomVariables[NR_RANDOM_VARIABLES];
 /******************************************************************************/
 
 /******************************************************************************/
 /* function callbacks for the random number generating function */
 static VALUE (*outcome_func[NR_RANDOM_VARIABLES])(randvar_t *);
+static void (*fill_func[NR_RANDOM_VARIABLES])(randvar_t *, void *, long);
+static kind_t outcome_kind[NR_RANDOM_VARIABLES];
+static int reentrant[NR_RANDOM_VARIABLES];
 /******************************************************************************/
 
 static type_t type(VALUE rb_obj)
@@ -354,7 +678,8 @@ static type_t type(VALUE rb_obj)
 
 
 #define GET_NEXT_ARG(ap)	va_arg((ap), VALUE)
-#define CREATE_WRAPPING(rv)	Data_Wrap_Struct(klass, NULL, xfree, (rv))
+#define CREATE_WRAPPING(rv)						\
+	Data_Wrap_Struct(klass, randvar_mark, randvar_free, (rv))
 
 #define SET_PARAM(name, param)						\
 	randvar_ ##name ##_set_ ##param(rv, param)
@@ -364,6 +689,10 @@ static type_t type(VALUE rb_obj)
 	do {								\
 		rv = RANDVAR_ALLOC();					\
 		RANDVAR_TYPE(rv) = rv_type_ ##name;			\
+		RANDVAR_KIND(rv) = outcome_kind[rv_type_ ##name];	\
+		RANDVAR_REENTRANT(rv) = reentrant[rv_type_ ##name];	\
+		RANDVAR_GEN(rv) = NULL;					\
+		rv->rb_gen = Qnil;					\
 		rb_rv = CREATE_WRAPPING(rv);				\
 	} while (0)		
 
@@ -375,6 +704,611 @@ static type_t type(VALUE rb_obj)
 			ASSERT_KLASS_IS_SET;				\
 			break;						\
 			}	
+static void randvar_mark(randvar_t *rv)
+{
+	rb_gc_mark(rv->rb_gen);
+	if (rv_type_categorical == RANDVAR_TYPE(rv))
+		rb_gc_mark(randvar_categorical_rb_values(rv));
+	if (rv_type_expression == RANDVAR_TYPE(rv)) {
+		rb_gc_mark(rv->RANDVAR_DATA.expression.left.rb_obj);
+		rb_gc_mark(rv->RANDVAR_DATA.expression.right.rb_obj);
+	}
+	if (rv_type_mixture == RANDVAR_TYPE(rv))
+		rb_gc_mark(rv->RANDVAR_DATA.mixture.rb_components);
+}
+
+static void program_free(program_t *prog);
+
+static void randvar_free(randvar_t *rv)
+{
+	if (rv_type_categorical == RANDVAR_TYPE(rv))
+		rv_alias_free(randvar_categorical_table(rv));
+	if (rv_type_expression == RANDVAR_TYPE(rv))
+		program_free(rv->RANDVAR_DATA.expression.program);
+	if (rv_type_mixture == RANDVAR_TYPE(rv)) {
+		rv_alias_free(rv->RANDVAR_DATA.mixture.table);
+		xfree(rv->RANDVAR_DATA.mixture.components);
+	}
+	if (rv_type_multivariate_normal == RANDVAR_TYPE(rv))
+		xfree(rv->RANDVAR_DATA.multivariate_normal.parm);
+	xfree(rv);
+}
+
+/* the random variable of rb_obj if it is implemented by this extension and
+   its native outcomes are its outcomes, which is not the case of the
+   categorical random variables with values, nor of the vector valued
+   multivariate normals */
+static randvar_t *native_randvar(VALUE rb_obj)
+{
+	randvar_t *rv;
+
+	if (!RB_TYPE_P(rb_obj, T_DATA) || 
+		(RUBY_DATA_FUNC) randvar_free != RDATA(rb_obj)->dfree)
+		return NULL;
+	rv = DATA_PTR(rb_obj);
+	if (rv_type_categorical == RANDVAR_TYPE(rv) &&
+		!NIL_P(randvar_categorical_rb_values(rv)))
+		return NULL;
+	if (rv_type_multivariate_normal == RANDVAR_TYPE(rv))
+		return NULL;
+	return rv;
+}
+
+/******************************************************************************/
+/* expressions over random variables and numbers, evaluated natively */
+/******************************************************************************/
+RV_NR_PARAMS(expression, 3)
+CREATE_RANDVAR_ACCESSOR(expression, op, rv_op_t)
+CREATE_RANDVAR_ACCESSOR(expression, left, operand_t)
+CREATE_RANDVAR_ACCESSOR(expression, right, operand_t)
+CREATE_RANDVAR_ACCESSOR(expression, program, program_t *)
+/* both of them are actually set per instance */
+static const kind_t rv_expression_kind = rv_kind_double;
+RV_REENTRANT(expression, 0)
+
+/* an expression is evaluated by a program with a step per distinct random
+   variable it is made of, the steps of the operands coming before those of
+   the expressions they take part in and the expression itself being the
+   last one; a random variable appearing several times in the expression is
+   thus sampled once per outcome, wherever it appears taking that outcome */
+typedef struct {
+	randvar_t *rv;
+	VALUE rb_obj;		/* that of rv, Qnil for the expression itself */
+	long left, right;	/* steps of its operands, -1 for numbers */
+} step_t;
+
+struct program {
+	long nr_steps, capa;
+	step_t *steps;
+};
+
+static void program_free(program_t *prog)
+{
+	if (NULL == prog)
+		return;
+	xfree(prog->steps);
+	xfree(prog);
+}
+
+/* the step of rv, added after those of its operands unless seen before */
+static long program_add(program_t *prog, st_table *seen, randvar_t *rv,
+							VALUE rb_obj)
+{
+	st_data_t step;
+	long left = -1, right = -1;
+
+	if (st_lookup(seen, (st_data_t) rv, &step))
+		return (long) step;
+
+	if (rv_type_expression == RANDVAR_TYPE(rv)) {
+		const operand_t *l = &rv->RANDVAR_DATA.expression.left;
+		const operand_t *r = &rv->RANDVAR_DATA.expression.right;
+
+		if (NULL != l->rv)
+			left = program_add(prog, seen, l->rv, l->rb_obj);
+		if (NULL != r->rv)
+			right = program_add(prog, seen, r->rv, r->rb_obj);
+	}
+
+	if (prog->nr_steps == prog->capa) {
+		prog->capa *= 2;
+		REALLOC_N(prog->steps, step_t, prog->capa);
+	}
+	prog->steps[prog->nr_steps].rv = rv;
+	prog->steps[prog->nr_steps].rb_obj = rb_obj;
+	prog->steps[prog->nr_steps].left = left;
+	prog->steps[prog->nr_steps].right = right;
+	st_insert(seen, (st_data_t) rv, (st_data_t) prog->nr_steps);
+	return prog->nr_steps++;
+}
+
+/* the outcomes are evaluated a chunk at a time, every step filling a
+   column of at most EXPR_CHUNK values and every operator being applied
+   over whole columns; the columns of the steps and two more for operands
+   converted from longs into doubles are laid out in no more than
+   EXPR_SCRATCH values of scratch space */
+#define EXPR_CHUNK	1024L
+#define EXPR_SCRATCH	8192L
+/* the scratch space of a worker of a job, allocated once and taken in
+   stack order, as an expression may be evaluated within another one, e.g.
+   as a component of a mixture */
+#define EXPR_ARENA	(4 * EXPR_SCRATCH)
+
+typedef struct {
+	rv_value_t *values;	/* NULL until an expression is evaluated */
+	long used;
+	int failed;		/* on running short of memory */
+	int overflowed;		/* on an Integer outcome not fitting a long */
+} scratch_t;
+
+/* that of the worker running on this thread, NULL holding the GVL */
+#ifdef RV_THREAD_LOCAL
+static RV_THREAD_LOCAL scratch_t *cur_scratch = NULL;
+#else
+static scratch_t *cur_scratch = NULL;
+#endif
+
+/* the program of an expression is compiled by its first evaluation, which
+   holds the GVL */
+static void expression_compile(randvar_t *rv)
+{
+	program_t *prog;
+	st_table *seen;
+
+	if (rv_type_expression != RANDVAR_TYPE(rv) ||
+		NULL != randvar_expression_program(rv))
+		return;
+
+	prog = ALLOC(program_t);
+	prog->nr_steps = 0;
+	prog->capa = 8;
+	prog->steps = ALLOC_N(step_t, prog->capa);
+	seen = st_init_numtable();
+	program_add(prog, seen, rv, Qnil);
+	st_free_table(seen);
+	randvar_expression_set_program(rv, prog);
+
+	/* the columns of a bigger one do not fit in the scratch space,
+	   they are allocated holding the GVL */
+	if (prog->nr_steps + 2 > EXPR_SCRATCH)
+		RANDVAR_REENTRANT(rv) = 0;
+}
+
+/* nr outcomes of a random variable which is not an expression */
+static void leaf_column(randvar_t *rv, rv_value_t *v, long nr)
+{
+	long i;
+
+	(*fill_func[RANDVAR_TYPE(rv)])(rv, v, nr);
+
+	/* spread the outcomes if they are narrower than the values */
+	if (rv_kind_long == RANDVAR_KIND(rv) && 
+		sizeof(long) != sizeof(rv_value_t))
+		for (i = nr - 1; i >= 0; i--)
+			v[i].l = ((long *) v)[i];
+}
+
+/* nr outcomes of the expression of a step out of the columns of its
+   operands, it returns what rv_op_long_n() does */
+static int step_column(const program_t *prog, long s, rv_value_t *columns,
+			long chunk, long nr)
+{
+	randvar_t *rv = prog->steps[s].rv;
+	const operand_t *operands[2] = {
+		&rv->RANDVAR_DATA.expression.left,
+		&rv->RANDVAR_DATA.expression.right
+	};
+	const long steps[2] = { prog->steps[s].left, prog->steps[s].right };
+	rv_value_t *tmp = columns + prog->nr_steps * chunk;
+	rv_value_t *out = columns + s * chunk;
+	const rv_value_t *in[2];
+	int in_step[2], i;
+
+	for (i = 0; i < 2; i++) {
+		/* a number takes a single value, its step being zero */
+		if (steps[i] < 0) {
+			in[i] = &operands[i]->value;
+			in_step[i] = 0;
+		} else {
+			in[i] = columns + steps[i] * chunk;
+			in_step[i] = 1;
+		}
+
+		/* as the column may be read by other steps, it is converted
+		   into a column of its own */
+		if (rv_kind_double == RANDVAR_KIND(rv) && 
+			rv_kind_long == operands[i]->kind) {
+			rv_value_to_double_n(tmp + i * chunk, in[i],
+						in_step[i] ? nr : 1);
+			in[i] = tmp + i * chunk;
+		}
+	}
+
+	if (rv_kind_long == RANDVAR_KIND(rv))
+		return rv_op_long_n(randvar_expression_op(rv), out,
+				in[0], in_step[0], in[1], in_step[1], nr);
+	rv_op_double_n(randvar_expression_op(rv), out,
+			in[0], in_step[0], in[1], in_step[1], nr);
+	return 0;
+}
+
+/* nr outcomes into the column of the last step, it stops at the first
+   step failing */
+static int program_run(const program_t *prog, rv_value_t *columns,
+			long chunk, long nr)
+{
+	long s;
+	int ret;
+
+	for (s = 0; s < prog->nr_steps; s++) {
+		randvar_t *rv = prog->steps[s].rv;
+
+		if (rv_type_expression != RANDVAR_TYPE(rv))
+			leaf_column(rv, columns + s * chunk, nr);
+		else if (0 != (ret = step_column(prog, s, columns, chunk, nr)))
+			return ret;
+	}
+	return 0;
+}
+
+/* size values out of the scratch space of the worker on this thread, NULL
+   if short of memory; *tmp is set if they had to be allocated apart */
+static rv_value_t *scratch_take(scratch_t *scratch, long size, 
+							rv_value_t **tmp)
+{
+	rv_value_t *columns;
+
+	*tmp = NULL;
+	if (NULL == scratch->values) {
+		scratch->values = malloc(EXPR_ARENA * sizeof(rv_value_t));
+		scratch->used = 0;
+	}
+	if (NULL != scratch->values && scratch->used + size <= EXPR_ARENA) {
+		columns = scratch->values + scratch->used;
+		scratch->used += size;
+		return columns;
+	}
+	/* nested too deeply for the scratch space */
+	if (NULL == (*tmp = malloc(size * sizeof(rv_value_t))))
+		scratch->failed = 1;
+	return *tmp;
+}
+
+static void scratch_give_back(scratch_t *scratch, long size, rv_value_t *tmp)
+{
+	if (NULL != tmp)
+		free(tmp);
+	else
+		scratch->used -= size;
+}
+
+static void raise_overflow(void)
+{
+	rb_raise(rb_eRangeError, "an Integer outcome does not fit in a "
+					"native integer");
+}
+
+/* it may run without the GVL, and it only raises or allocates memory
+   through the Ruby API holding it; an overflow without the GVL is left for
+   the job to raise */
+static void randvar_expression_fill(randvar_t *rv, void *buf, long nr)
+{
+	const program_t *prog = randvar_expression_program(rv);
+	long nr_columns = prog->nr_steps + 2;
+	scratch_t *scratch = cur_scratch;
+	rv_value_t *columns, *tmp = NULL, *out;
+	VALUE rb_tmp = 0;
+	long chunk, done, n, i;
+	int failed = 0;
+
+	if (nr < 1)
+		return;
+
+	chunk = EXPR_SCRATCH / nr_columns;
+	if (chunk > EXPR_CHUNK)
+		chunk = EXPR_CHUNK;
+	if (chunk > nr)
+		chunk = nr;
+	if (chunk < 1)
+		chunk = 1;
+	/* holding the GVL there is no scratch space */
+	if (NULL == scratch)
+		columns = ALLOCV_N(rv_value_t, rb_tmp, nr_columns * chunk);
+	else if (NULL == (columns = scratch_take(scratch, 
+					nr_columns * chunk, &tmp)))
+		return;
+
+	out = columns + (prog->nr_steps - 1) * chunk;
+	for (done = 0; done < nr && !failed; done += n) {
+		n = nr - done;
+		if (n > chunk)
+			n = chunk;
+		failed = program_run(prog, columns, chunk, n);
+		if (rv_kind_long == RANDVAR_KIND(rv))
+			for (i = 0; i < n; i++)
+				((long *) buf)[done + i] = out[i].l;
+		else
+			for (i = 0; i < n; i++)
+				((double *) buf)[done + i] = out[i].d;
+	}
+	if (NULL == scratch)
+		ALLOCV_END(rb_tmp);
+	else
+		scratch_give_back(scratch, nr_columns * chunk, tmp);
+
+	if (RV_OP_ZERO_DIV == failed)
+		rb_raise(rb_eZeroDivError, "divided by 0");
+	if (RV_OP_OVERFLOW == failed) {
+		if (NULL != scratch)
+			scratch->overflowed = 1;
+		else
+			raise_overflow();
+	}
+}
+
+static VALUE randvar_expression_rb_outcome(randvar_t *rv)
+{
+	rv_value_t v;
+
+	expression_compile(rv);
+	randvar_expression_fill(rv, &v, 1);
+	if (rv_kind_long == RANDVAR_KIND(rv))
+		return LONG2NUM(v.l);
+	return DBL2NUM(v.d);
+}
+
+/******************************************************************************/
+/* mixtures of random variables, a component chosen by an alias table */
+/******************************************************************************/
+RV_NR_PARAMS(mixture, 2)
+CREATE_RANDVAR_ACCESSOR(mixture, table, rv_alias_t *)
+CREATE_RANDVAR_ACCESSOR(mixture, components, randvar_t **)
+CREATE_RANDVAR_ACCESSOR(mixture, rb_components, VALUE)
+/* both of them are actually set per instance */
+static const kind_t rv_mixture_kind = rv_kind_double;
+RV_REENTRANT(mixture, 0)
+
+/* the outcomes are drawn a chunk at a time: the components of the whole
+   chunk are chosen first, so that every component is then sampled at once
+   for all of its draws; the counts of up to MIXTURE_STACK components are
+   kept in the stack */
+#define MIXTURE_CHUNK	1024L
+#define MIXTURE_STACK	64L
+
+#define VALUE_AS_DOUBLE(kind, v)					\
+	((rv_kind_long == (kind)) ? (double) (v).l : (v).d)
+
+static inline void mixture_store(randvar_t *rv, void *buf, long i,
+					kind_t kind, rv_value_t v)
+{
+	if (rv_kind_long == RANDVAR_KIND(rv))
+		((long *) buf)[i] = v.l;
+	else
+		((double *) buf)[i] = VALUE_AS_DOUBLE(kind, v);
+}
+
+/* it may run without the GVL, and it only raises or allocates memory
+   through the Ruby API when the mixture is not reentrant */
+static void randvar_mixture_fill(randvar_t *rv, void *buf, long nr)
+{
+	const rv_alias_t *table = randvar_mixture_table(rv);
+	randvar_t **components = randvar_mixture_components(rv);
+	long nr_components = table->n;
+	long which[MIXTURE_CHUNK], order[MIXTURE_CHUNK];
+	long stack_first[MIXTURE_STACK], *first = stack_first;
+	rv_value_t values[MIXTURE_CHUNK];
+	rv_gen_t *gen = rv_gen_current();
+	VALUE rb_tmp = 0;
+	long done, n, i, c, end;
+
+	if (nr_components > MIXTURE_STACK) {
+		if (RANDVAR_REENTRANT(rv))
+			first = malloc(nr_components * sizeof(long));
+		else
+			first = ALLOCV_N(long, rb_tmp, nr_components);
+	}
+
+	/* short of memory, one outcome after the other */
+	if (NULL == first) {
+		for (i = 0; i < nr; i++) {
+			randvar_t *component = components[
+						rv_alias_draw(table, gen)];
+
+			leaf_column(component, values, 1);
+			mixture_store(rv, buf, i, RANDVAR_KIND(component),
+					values[0]);
+		}
+		return;
+	}
+
+	for (done = 0; done < nr; done += n) {
+		n = nr - done;
+		if (n > MIXTURE_CHUNK)
+			n = MIXTURE_CHUNK;
+
+		for (c = 0; c < nr_components; c++)
+			first[c] = 0;
+		for (i = 0; i < n; i++)
+			first[which[i] = rv_alias_draw(table, gen)]++;
+
+		/* sorted by component, the draws of component c take up
+		   order[first[c]] to order[first[c + 1] - 1] */
+		for (c = 1; c < nr_components; c++)
+			first[c] += first[c - 1];
+		for (i = n - 1; i >= 0; i--)
+			order[--first[which[i]]] = i;
+
+		for (c = 0; c < nr_components; c++) {
+			end = (c + 1 < nr_components) ? first[c + 1] : n;
+			if (end > first[c])
+				leaf_column(components[c], values + first[c],
+						end - first[c]);
+		}
+
+		for (c = 0; c < nr_components; c++) {
+			end = (c + 1 < nr_components) ? first[c + 1] : n;
+			for (i = first[c]; i < end; i++)
+				mixture_store(rv, buf, done + order[i],
+					RANDVAR_KIND(components[c]), values[i]);
+		}
+	}
+
+	if (stack_first != first) {
+		if (RANDVAR_REENTRANT(rv))
+			free(first);
+		else
+			ALLOCV_END(rb_tmp);
+	}
+}
+
+static VALUE randvar_mixture_rb_outcome(randvar_t *rv)
+{
+	rv_value_t v;
+
+	randvar_mixture_fill(rv, &v, 1);
+	if (rv_kind_long == RANDVAR_KIND(rv))
+		return LONG2NUM(v.l);
+	return DBL2NUM(v.d);
+}
+
+/******************************************************************************/
+/* multivariate normals, whose outcomes are vectors of p doubles */
+/******************************************************************************/
+RV_NR_PARAMS(multivariate_normal, 2)
+CREATE_RANDVAR_ACCESSOR(multivariate_normal, p, long)
+CREATE_RANDVAR_ACCESSOR(multivariate_normal, parm, double *)
+static const kind_t rv_multivariate_normal_kind = rv_kind_double;
+RV_REENTRANT(multivariate_normal, 1)
+
+/* so that p * p and the sizes worked out of it fit in a long */
+#define MVN_MAX_DIMENSION	(1L << 15)
+
+/* the number of native values each outcome is made of */
+static inline long randvar_width(randvar_t *rv)
+{
+	if (rv_type_multivariate_normal == RANDVAR_TYPE(rv))
+		return randvar_multivariate_normal_p(rv);
+	return 1;
+}
+
+static void randvar_multivariate_normal_fill(randvar_t *rv, void *buf, long nr)
+{
+	gen_multivariate_normal_fill(randvar_multivariate_normal_parm(rv),
+					(double *) buf, nr);
+}
+
+static VALUE vector_to_ary(const double *x, long p)
+{
+	VALUE rb_ary = rb_ary_new_capa(p);
+	long i;
+
+	for (i = 0; i < p; i++)
+		rb_ary_push(rb_ary, DBL2NUM(x[i]));
+	return rb_ary;
+}
+
+static VALUE randvar_multivariate_normal_rb_outcome(randvar_t *rv)
+{
+	long p = randvar_multivariate_normal_p(rv);
+	VALUE rb_tmp, rb_ary;
+	double *x;
+
+	x = ALLOCV_N(double, rb_tmp, p);
+	randvar_multivariate_normal_fill(rv, x, 1);
+	rb_ary = vector_to_ary(x, p);
+	ALLOCV_END(rb_tmp);
+	return rb_ary;
+}
+
+/* whether rb_obj can be a native operand: a native random variable, a
+   Fixnum or a Float */
+static int operand_init(operand_t *operand, VALUE rb_obj)
+{
+	operand->rb_obj = rb_obj;
+	operand->rv = NULL;
+
+	if (FIXNUM_P(rb_obj)) {
+		operand->kind = rv_kind_long;
+		operand->value.l = FIX2LONG(rb_obj);
+	} else if (RB_TYPE_P(rb_obj, T_FLOAT)) {
+		operand->kind = rv_kind_double;
+		operand->value.d = RFLOAT_VALUE(rb_obj);
+	} else if (NULL != (operand->rv = native_randvar(rb_obj))) {
+		operand->kind = RANDVAR_KIND(operand->rv);
+	} else {
+		return 0;
+	}
+	return 1;
+}
+
+static rv_op_t op_from_symbol(VALUE rb_op)
+{
+	static const char *names[RV_NR_OPS] = {
+		"+", "-", "*", "/", "%", "**",
+		"acos", "acosh", "asin", "asinh", "atan", "atanh", "cbrt",
+		"cos", "cosh", "erf", "erfc", "exp", "gamma", "log", "log10",
+		"log2", "sin", "sinh", "sqrt", "tan", "tanh"
+	};
+	int i;
+
+	if (SYMBOL_P(rb_op))
+		for (i = 0; i < RV_NR_OPS; i++)
+			if (rb_intern(names[i]) == SYM2ID(rb_op))
+				return i;
+	rb_raise(rb_eArgError, "unknown operator");
+}
+
+/* an integer division by a random variable or by zero may raise, so
+   it has to be evaluated holding the GVL */
+static int operand_may_raise(rv_op_t op, kind_t kind, const operand_t *right)
+{
+	if (rv_kind_long != kind || (rv_op_div != op && rv_op_mod != op))
+		return 0;
+	return NULL != right->rv || 0 == right->value.l;
+}
+
+#define OPERAND_REENTRANT(operand)					\
+	(NULL == (operand).rv || RANDVAR_REENTRANT((operand).rv))
+
+/* rv, an expression or a mixture, draws all of its outcomes from a single
+   generator: that of the first of its random variables bound to one, the
+   default one if none is; they cannot be bound to different ones */
+static void composite_bind(randvar_t *rv, const randvar_t *part)
+{
+	if (NULL == RANDVAR_GEN(part))
+		return;
+	if (NULL == RANDVAR_GEN(rv)) {
+		RANDVAR_GEN(rv) = RANDVAR_GEN(part);
+		rv->rb_gen = part->rb_gen;
+	} else if (RANDVAR_GEN(rv) != RANDVAR_GEN(part)) {
+		rb_raise(rb_eArgError, "the random variables are bound to "
+						"different generators");
+	}
+}
+
+/* the n weights of a categorical choice into weights, they are finite and
+   non-negative and add up to a positive finite number */
+static void get_weights(VALUE rb_weights, double *weights, long n)
+{
+	double sum;
+	long i;
+
+	if (0 == n)
+		rb_raise(rb_eArgError, "no weights given");
+
+	for (i = 0, sum = 0.0; i < n; i++) {
+		weights[i] = NUM2DBL(rb_ary_entry(rb_weights, i));
+		if (!isfinite(weights[i]) || weights[i] < 0.0)
+			rb_raise(rb_eArgError, "weights must be "
+					"finite and non-negative");
+		sum += weights[i];
+	}
+
+	if (!isfinite(sum) || sum <= 0.0)
+		rb_raise(rb_eArgError, "the weights must add up "
+				"to a positive finite number");
+}
+
 /******************************************************************************/
 /* instantiate Ruby random variable objects */
 /******************************************************************************/
@@ -389,6 +1323,8 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 		CASE(bernoulli)
 			VALUE rb_p;
 			double p;
+			uint64_t threshold;
+			int i;
 
 			SET_KLASS(bernoulli);
 
@@ -403,6 +1339,16 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			/* p parameter correct */
 			RANDVAR_INIT(bernoulli);
 			SET_PARAM(bernoulli, p);
+
+			/* exact as p < 1, a p below 2^-64 never succeeds */
+			threshold = (uint64_t) ldexp(p, 64);
+			rv->RANDVAR_DATA.bernoulli.threshold = threshold;
+			rv->RANDVAR_DATA.bernoulli.low = 64;
+			for (i = 0; i < 64; i++)
+				if ((threshold >> i) & 1) {
+					rv->RANDVAR_DATA.bernoulli.low = i;
+					break;
+				}
 		CASE_END
 
 		CASE(beta)
@@ -430,6 +1376,11 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			RANDVAR_INIT(beta);
 			SET_PARAM(beta, alpha);
 			SET_PARAM(beta, beta);
+			genbet_setup(RANDVAR_SETUP(rv, beta), alpha, beta);
+			if (BETA_BY_GAMMA(rv)) {
+				gen_gamma_setup(BETA_GAMMA(rv, alpha), alpha);
+				gen_gamma_setup(BETA_GAMMA(rv, beta), beta);
+			}
 		CASE_END
 
 		CASE(binomial)
@@ -459,6 +1410,99 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			RANDVAR_INIT(binomial);
 			SET_PARAM(binomial, n);
 			SET_PARAM(binomial, p);
+			ignbin_setup(RANDVAR_SETUP(rv, binomial), n, p);
+		CASE_END
+
+		CASE(categorical)
+			VALUE rb_weights, rb_values, rb_tmp;
+			rv_alias_t *table;
+			double *weights;
+			long n;
+
+			SET_KLASS(categorical);
+
+			rb_weights = GET_NEXT_ARG(ap);
+			rb_values = GET_NEXT_ARG(ap);
+
+			Check_Type(rb_weights, T_ARRAY);
+			n = RARRAY_LEN(rb_weights);
+			if (!NIL_P(rb_values)) {
+				Check_Type(rb_values, T_ARRAY);
+				if (RARRAY_LEN(rb_values) != n)
+					rb_raise(rb_eArgError, "as many "
+						"values as weights are needed");
+				rb_values = rb_ary_freeze(
+						rb_ary_dup(rb_values));
+			}
+
+			weights = ALLOCV_N(double, rb_tmp, n);
+			get_weights(rb_weights, weights, n);
+
+			/* the table is only set once it is owned by rv */
+			RANDVAR_INIT(categorical);
+			table = NULL;
+			SET_PARAM(categorical, table);
+			SET_PARAM(categorical, rb_values);
+			table = rv_alias_alloc(n);
+			SET_PARAM(categorical, table);
+			rv_alias_build(table, weights);
+			ALLOCV_END(rb_tmp);
+		CASE_END
+
+		CASE(expression)
+			VALUE rb_op, rb_left, rb_right;
+			operand_t left, right;
+			rv_op_t op;
+			kind_t kind;
+
+			SET_KLASS(expression);
+
+			rb_op = GET_NEXT_ARG(ap);
+			rb_left = GET_NEXT_ARG(ap);
+			rb_right = GET_NEXT_ARG(ap);
+
+			op = op_from_symbol(rb_op);
+
+			/* the right operand of a unary operator is unused */
+			if (RV_OP_IS_UNARY(op))
+				rb_right = INT2FIX(0);
+
+			/* nil tells the caller to fall back to a Ruby block,
+			   which is also the case of an Integer raised to an
+			   Integer, an Integer or a Rational in Ruby */
+			if (!operand_init(&left, rb_left) ||
+				!operand_init(&right, rb_right) ||
+				(NULL == left.rv && NULL == right.rv) ||
+				(RV_OP_IS_UNARY(op) && NULL == left.rv) ||
+				(rv_op_pow == op && 
+					rv_kind_long == left.kind &&
+					rv_kind_long == right.kind)) {
+				rb_rv = Qnil;
+				break;
+			}
+
+			/* as Ruby does, longs are promoted to doubles */
+			if (rv_kind_long == left.kind && 
+				rv_kind_long == right.kind && 
+				RV_OP_KEEPS_LONG(op))
+				kind = rv_kind_long;
+			else
+				kind = rv_kind_double;
+
+			RANDVAR_INIT(expression);
+			SET_PARAM(expression, op);
+			SET_PARAM(expression, left);
+			SET_PARAM(expression, right);
+			randvar_expression_set_program(rv, NULL);
+			RANDVAR_KIND(rv) = kind;
+			RANDVAR_REENTRANT(rv) = OPERAND_REENTRANT(left) &&
+				OPERAND_REENTRANT(right) &&
+				!operand_may_raise(op, kind, &right);
+
+			if (NULL != left.rv)
+				composite_bind(rv, left.rv);
+			if (NULL != right.rv)
+				composite_bind(rv, right.rv);
 		CASE_END
 
 		CASE(chi_squared)
@@ -478,6 +1522,7 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			/* k parameter correct */
 			RANDVAR_INIT(chi_squared);
 			SET_PARAM(chi_squared, k);	
+			gamma_setup(RANDVAR_SETUP(rv, chi_squared), k / 2.0);
 		CASE_END
 
 		CASE(continuous_uniform)
@@ -571,6 +1616,173 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			RANDVAR_INIT(f);
 			SET_PARAM(f, d1);
 			SET_PARAM(f, d2);
+			gamma_setup(&rv->RANDVAR_DATA.f.setup_d1, d1 / 2.0);
+			gamma_setup(&rv->RANDVAR_DATA.f.setup_d2, d2 / 2.0);
+		CASE_END
+
+		CASE(gamma)
+			VALUE rb_shape, rb_scale;
+			double shape, scale;
+
+			SET_KLASS(gamma);
+
+			rb_shape = GET_NEXT_ARG(ap);
+			rb_scale = GET_NEXT_ARG(ap);
+
+			shape = NUM2DBL(rb_shape);
+			scale = NUM2DBL(rb_scale);
+
+			CHECK_NUMBER(shape);
+			CHECK_NUMBER(scale);
+
+			/* shape > 0 */
+			/* scale > 0 */
+			CHECK_POSITIVE(shape);
+			CHECK_POSITIVE(scale);
+
+			/* shape, scale parameters correct */
+			RANDVAR_INIT(gamma);
+			SET_PARAM(gamma, shape);
+			SET_PARAM(gamma, scale);
+			gamma_setup(RANDVAR_SETUP(rv, gamma), shape);
+		CASE_END
+
+		CASE(mixture)
+			VALUE rb_components, rb_weights, rb_tmp;
+			randvar_t **components;
+			rv_alias_t *table;
+			double *weights;
+			kind_t kind = rv_kind_long;
+			int all_reentrant = 1;
+			long n, i;
+
+			SET_KLASS(mixture);
+
+			rb_components = GET_NEXT_ARG(ap);
+			rb_weights = GET_NEXT_ARG(ap);
+
+			Check_Type(rb_components, T_ARRAY);
+			Check_Type(rb_weights, T_ARRAY);
+			n = RARRAY_LEN(rb_components);
+			if (RARRAY_LEN(rb_weights) != n)
+				rb_raise(rb_eArgError, "as many weights "
+						"as components are needed");
+			weights = ALLOCV_N(double, rb_tmp, n);
+			get_weights(rb_weights, weights, n);
+
+			/* as for expressions, longs are promoted to doubles */
+			for (i = 0; i < n; i++) {
+				randvar_t *component = native_randvar(
+						rb_ary_entry(rb_components, i));
+
+				if (NULL == component)
+					break;
+				expression_compile(component);
+				if (rv_kind_double == RANDVAR_KIND(component))
+					kind = rv_kind_double;
+				if (!RANDVAR_REENTRANT(component))
+					all_reentrant = 0;
+			}
+
+			/* nil tells the caller to fall back to a Ruby block */
+			if (i < n) {
+				ALLOCV_END(rb_tmp);
+				rb_rv = Qnil;
+				break;
+			}
+			rb_components = rb_ary_freeze(
+					rb_ary_dup(rb_components));
+
+			/* the table and the components are only set once they
+			   are owned by rv */
+			RANDVAR_INIT(mixture);
+			table = NULL;
+			components = NULL;
+			SET_PARAM(mixture, table);
+			SET_PARAM(mixture, components);
+			SET_PARAM(mixture, rb_components);
+			RANDVAR_KIND(rv) = kind;
+			RANDVAR_REENTRANT(rv) = all_reentrant;
+
+			components = ALLOC_N(randvar_t *, n);
+			for (i = 0; i < n; i++)
+				components[i] = DATA_PTR(
+						rb_ary_entry(rb_components, i));
+			SET_PARAM(mixture, components);
+			table = rv_alias_alloc(n);
+			SET_PARAM(mixture, table);
+			rv_alias_build(table, weights);
+			ALLOCV_END(rb_tmp);
+			for (i = 0; i < n; i++)
+				composite_bind(rv, components[i]);
+		CASE_END
+
+		CASE(multivariate_normal)
+			VALUE rb_mean, rb_cov, rb_row, rb_tmp;
+			double *mean, *cov, *parm, upper, lower;
+			long p, i, j, info;
+
+			SET_KLASS(multivariate_normal);
+
+			rb_mean = GET_NEXT_ARG(ap);
+			rb_cov = GET_NEXT_ARG(ap);
+
+			Check_Type(rb_mean, T_ARRAY);
+			Check_Type(rb_cov, T_ARRAY);
+			p = RARRAY_LEN(rb_mean);
+			if (0 == p)
+				rb_raise(rb_eArgError, "empty mean vector");
+			if (p > MVN_MAX_DIMENSION)
+				rb_raise(rb_eArgError, "too many dimensions");
+			if (RARRAY_LEN(rb_cov) != p)
+				rb_raise(rb_eArgError, "the covariance matrix "
+					"must be %ld by %ld", p, p);
+
+			/* the mean followed by the covariance, by columns */
+			mean = ALLOCV_N(double, rb_tmp, p + p * p);
+			cov = mean + p;
+			for (i = 0; i < p; i++) {
+				mean[i] = NUM2DBL(rb_ary_entry(rb_mean, i));
+				CHECK_NUMBER(mean[i]);
+			}
+			for (i = 0; i < p; i++) {
+				rb_row = rb_ary_entry(rb_cov, i);
+				Check_Type(rb_row, T_ARRAY);
+				if (RARRAY_LEN(rb_row) != p)
+					rb_raise(rb_eArgError, "the covariance "
+						"matrix must be %ld by %ld", 
+						p, p);
+				for (j = 0; j < p; j++) {
+					cov[i + j * p] = NUM2DBL(
+						rb_ary_entry(rb_row, j));
+					CHECK_NUMBER(cov[i + j * p]);
+				}
+			}
+			for (i = 0; i < p; i++)
+				for (j = 0; j < i; j++) {
+					lower = cov[i + j * p];
+					upper = cov[j + i * p];
+					if (fabs(lower - upper) > 1e-12 * 
+						(fabs(lower) + fabs(upper)))
+						rb_raise(rb_eArgError, "the "
+							"covariance matrix is "
+							"not symmetric");
+				}
+
+			/* parm is only set once it is owned by rv */
+			RANDVAR_INIT(multivariate_normal);
+			parm = NULL;
+			SET_PARAM(multivariate_normal, p);
+			SET_PARAM(multivariate_normal, parm);
+
+			parm = ALLOC_N(double, 1 + p + p * (p + 1) / 2);
+			SET_PARAM(multivariate_normal, parm);
+			info = gen_multivariate_normal_setup(parm, mean, 
+								cov, p);
+			ALLOCV_END(rb_tmp);
+			if (0 != info)
+				rb_raise(rb_eArgError, "the covariance "
+					"matrix is not positive definite");
 		CASE_END
 
 		CASE(negative_binomial)
@@ -674,6 +1886,10 @@ VALUE rb_create_instance(VALUE rb_obj, ...)
 			/* mean parameter correct */
 			RANDVAR_INIT(poisson);
 			SET_PARAM(poisson, mean);
+			ignpoi_setup(RANDVAR_SETUP(rv, poisson), mean);
+			if (mean >= POISSON_PTRS_MIN)
+				gen_poisson_ptrs_setup(
+					&rv->RANDVAR_DATA.poisson.ptrs, mean);
 		CASE_END
 
 		CASE(rademacher)
@@ -738,10 +1954,55 @@ VALUE rb_outcome(VALUE rb_obj)
 	randvar_t *rv = NULL;
 	
 	GET_DATA(rb_obj, rv);
+	rv_gen_select(RANDVAR_GEN(rv));
 
 	return (*(outcome_func[RANDVAR_TYPE(rv)]))(rv);
 }
 
+/* the outcome of an expression within a joint draw of Generic, its random
+   variables taking the outcomes they have in that draw, which they share
+   with the blocks it is made of */
+VALUE rb_expression_joint_outcome(VALUE rb_obj)
+{
+	randvar_t *rv = NULL;
+	const program_t *prog;
+	rv_value_t *columns;
+	VALUE rb_tmp, rb_value;
+	long s;
+	int failed = 0;
+
+	GET_DATA(rb_obj, rv);
+	expression_compile(rv);
+	prog = randvar_expression_program(rv);
+
+	/* the columns of the steps, of a single value, and two more */
+	columns = ALLOCV_N(rv_value_t, rb_tmp, prog->nr_steps + 2);
+	for (s = 0; s < prog->nr_steps && !failed; s++) {
+		const step_t *step = &prog->steps[s];
+
+		if (rv_type_expression == RANDVAR_TYPE(step->rv)) {
+			failed = step_column(prog, s, columns, 1, 1);
+			continue;
+		}
+		rb_value = rb_funcall(rb_cRandomVariables[rv_type_generic],
+				rb_intern("joint_outcome"), 1, step->rb_obj);
+		if (rv_kind_long == RANDVAR_KIND(step->rv))
+			columns[s].l = NUM2LONG(rb_value);
+		else
+			columns[s].d = NUM2DBL(rb_value);
+	}
+	s = prog->nr_steps - 1;
+	rb_value = (rv_kind_long == RANDVAR_KIND(rv)) ? 
+			LONG2NUM(columns[s].l) : DBL2NUM(columns[s].d);
+	ALLOCV_END(rb_tmp);
+
+	if (RV_OP_ZERO_DIV == failed)
+		rb_raise(rb_eZeroDivError, "divided by 0");
+	if (RV_OP_OVERFLOW == failed)
+		raise_overflow();
+	return rb_value;
+}
+
 static inline long get_nr_times(VALUE rb_nr_times)
 {
 	long nr_times;
@@ -753,23 +2014,997 @@ static inline long get_nr_times(VALUE rb_nr_times)
 }
 
 /******************************************************************************/
-/* obtain several outcomes from the Ruby random variable object */
+/* generation of outcomes without the GVL, split among native threads */
 /******************************************************************************/
-VALUE rb_outcomes(VALUE rb_obj, VALUE rb_nr_times)
+#if defined(RV_THREAD_LOCAL) && defined(HAVE_PTHREAD_H) && \
+	defined(HAVE_RB_THREAD_CALL_WITHOUT_GVL)
+#define RV_PARALLEL
+#endif
+
+/* number of outcomes from which on they are generated without the GVL,
+   each part of a job holds at least as many */
+#define PARALLEL_MIN		(1L << 16)
+/* number of outcomes generated between checks for interrupts */
+#define PARALLEL_CHUNK		4096L
+#define MAX_NR_THREADS		256L
+#define MAX_NR_PARTS		256L
+
+static long nr_threads = 1;
+
+/* it does the work on nr outcomes, out being where the first of them
+   goes */
+typedef void (*task_func_t)(randvar_t *, void *, long);
+
+typedef struct job job_t;
+
+/* the outcomes are split in parts, each of them drawn from its own
+   substream by a single worker */
+typedef struct {
+	rv_gen_t gen;
+	void *out;
+	long nr;
+	long done;	/* outcomes dealt with so far, on a chunk boundary */
+} part_t;
+
+typedef struct {
+	job_t *job;
+	long first;	/* the part it starts with */
+} worker_t;
+
+struct job {
+	randvar_t *rv;
+	task_func_t task;
+	size_t outcome_stride;
+	part_t *parts;
+	long nr_parts;
+	worker_t *workers;
+	long nr_workers;
+	volatile int interrupted;
+	volatile int out_of_memory;
+	volatile int overflowed;
+};
+
+/* the number of parts nr outcomes are split in: it depends neither on the
+   number of threads nor on the machine, so that the outcomes of a seeded
+   generator do not either */
+static long job_nr_parts(long nr, long max_parts)
 {
-	randvar_t *rv = NULL;
+	long nr_parts = nr / PARALLEL_MIN;
+
+	if (nr_parts > max_parts)
+		nr_parts = max_parts;
+	return (nr_parts < 1) ? 1 : nr_parts;
+}
+
+/* the number of workers the parts are dealt to, worker i running parts
+   i, i + nr_workers, i + 2 nr_workers... one after the other */
+static long job_nr_workers(long nr, long max_parts)
+{
+#ifdef RV_PARALLEL
+	long nr_parts = job_nr_parts(nr, max_parts);
+
+	return (nr_parts < nr_threads) ? nr_parts : nr_threads;
+#else
+	return 1;
+#endif /* RV_PARALLEL */
+}
+
+static void *worker_run(void *arg)
+{
+	worker_t *worker = arg;
+	job_t *job = worker->job;
+	scratch_t scratch = { NULL, 0, 0, 0 };
+	part_t *part;
+	long i, nr;
+
+	cur_scratch = &scratch;
+	for (i = worker->first; i < job->nr_parts && !job->interrupted; 
+						i += job->nr_workers) {
+		part = &job->parts[i];
+		rv_gen_select(&part->gen);
+		for (; part->done < part->nr && !job->interrupted; 
+							part->done += nr) {
+			nr = part->nr - part->done;
+			if (nr > PARALLEL_CHUNK)
+				nr = PARALLEL_CHUNK;
+			(*job->task)(job->rv, (char *) part->out + 
+				part->done * job->outcome_stride, nr);
+			if (scratch.failed) {
+				job->out_of_memory = job->interrupted = 1;
+				break;
+			}
+			if (scratch.overflowed) {
+				job->overflowed = job->interrupted = 1;
+				break;
+			}
+		}
+	}
+	cur_scratch = NULL;
+	free(scratch.values);
+	return NULL;
+}
+
+#ifdef RV_PARALLEL
+static void *job_run(void *arg)
+{
+	job_t *job = arg;
+	pthread_t *threads;
+	int *started;
+	long i;
+
+	threads = malloc(job->nr_workers * sizeof(pthread_t));
+	started = calloc(job->nr_workers, sizeof(int));
+
+	/* on failure the remaining work is done on this very thread */
+	if (NULL != threads && NULL != started)
+		for (i = 1; i < job->nr_workers; i++)
+			started[i] = !pthread_create(&threads[i], NULL, 
+						worker_run, &job->workers[i]);
+	worker_run(&job->workers[0]);
+	for (i = 1; i < job->nr_workers; i++) {
+		if (NULL != started && started[i])
+			pthread_join(threads[i], NULL);
+		else
+			worker_run(&job->workers[i]);
+	}
+
+	free(threads);
+	free(started);
+	return NULL;
+}
+
+static void job_interrupt(void *arg)
+{
+	job_t *job = arg;
+	job->interrupted = 1;
+}
+#endif /* RV_PARALLEL */
+
+/* run task over nr outcomes of rv split in no more than max_parts parts,
+   part i writing at
+	out + i * part_stride + (first outcome of part i) * outcome_stride
+   the substream of each part is derived from the generator of rv, so the
+   outcome is reproducible for a given seed whatever the number of
+   threads */
+static void run_job(randvar_t *rv, long nr, task_func_t task, char *out,
+	size_t part_stride, size_t outcome_stride, long max_parts)
+{
+	job_t job;
+	rv_gen_t *parent, gen;
+	VALUE parts_v, workers_v;
+	long i, first;
+
+	parent = RANDVAR_GEN(rv);
+	if (NULL == parent)
+		parent = rv_gen_get(rv_gen_default());
+
+	job.rv = rv;
+	job.task = task;
+	job.outcome_stride = outcome_stride;
+	job.out_of_memory = 0;
+	job.overflowed = 0;
+	job.nr_parts = job_nr_parts(nr, max_parts);
+	job.nr_workers = job_nr_workers(nr, max_parts);
+	/* released by the GC too, should an interrupt raise */
+	job.parts = ALLOCV_N(part_t, parts_v, job.nr_parts);
+	job.workers = ALLOCV_N(worker_t, workers_v, job.nr_workers);
+
+	gen = *parent;
+	for (i = 0, first = 0; i < job.nr_parts; i++) {
+		part_t *part = &job.parts[i];
+
+		part->nr = nr / job.nr_parts + 
+				(i < nr % job.nr_parts ? 1 : 0);
+		part->out = out + i * part_stride + first * outcome_stride;
+		part->gen = gen;
+		part->done = 0;
+		rv_gen_jump(&gen);
+		first += part->nr;
+	}
+	for (i = 0; i < job.nr_workers; i++) {
+		job.workers[i].job = &job;
+		job.workers[i].first = i;
+	}
+	/* the parent stream goes on past all the substreams before the GVL
+	   is released, lest another Ruby thread drawing from the same
+	   generator meanwhile replays them */
+	rv_gen_long_jump(parent);
+
+	/* an interrupt stops the workers at the end of their chunks; once
+	   it has been handled, unless it raised, they go on where they
+	   stopped, each part still drawing from its own substream */
+	do {
+		job.interrupted = 0;
+#ifdef RV_PARALLEL
+		rb_thread_call_without_gvl(job_run, &job, job_interrupt, &job);
+#else
+		worker_run(&job.workers[0]);
+#endif
+		rv_gen_select(RANDVAR_GEN(rv));
+		if (job.out_of_memory) {
+			ALLOCV_END(parts_v);
+			ALLOCV_END(workers_v);
+			rb_memerror();
+		}
+		if (job.overflowed) {
+			ALLOCV_END(parts_v);
+			ALLOCV_END(workers_v);
+			raise_overflow();
+		}
+		if (job.interrupted)
+			rb_thread_check_ints();
+	} while (job.interrupted);
+
+	ALLOCV_END(parts_v);
+	ALLOCV_END(workers_v);
+}
+
+static void fill_task(randvar_t *rv, void *out, long nr)
+{
+	(*fill_func[RANDVAR_TYPE(rv)])(rv, out, nr);
+}
+
+/* nr outcomes into the native buffer buf, without the GVL if worth it */
+static void fill_outcomes(randvar_t *rv, void *buf, long nr)
+{
+	expression_compile(rv);
+	if (nr >= PARALLEL_MIN && RANDVAR_REENTRANT(rv)) {
+		run_job(rv, nr, fill_task, buf, 0, 
+			randvar_width(rv) * KIND_SIZE(RANDVAR_KIND(rv)),
+			MAX_NR_PARTS);
+		return;
+	}
+	rv_gen_select(RANDVAR_GEN(rv));
+	(*fill_func[RANDVAR_TYPE(rv)])(rv, buf, nr);
+}
+
+/* box the nr outcomes of buf into the first nr elements of outcomes_ary */
+static void box_outcomes(VALUE outcomes_ary, randvar_t *rv,
+				const void *buf, long nr)
+{
+	kind_t kind = RANDVAR_KIND(rv);
+	long i;
+
+	if (rv_type_categorical == RANDVAR_TYPE(rv))
+		for (i = 0; i < nr; i++)
+			rb_ary_store(outcomes_ary, i, randvar_categorical_value(
+					rv, ((const long *) buf)[i]));
+	else if (rv_type_multivariate_normal == RANDVAR_TYPE(rv))
+		for (i = 0; i < nr; i++)
+			rb_ary_store(outcomes_ary, i, vector_to_ary(
+				(const double *) buf + i * randvar_width(rv),
+				randvar_width(rv)));
+	else if (rv_kind_double == kind)
+		for (i = 0; i < nr; i++)
+			rb_ary_store(outcomes_ary, i,
+					DBL2NUM(((const double *) buf)[i]));
+	else
+		for (i = 0; i < nr; i++)
+			rb_ary_store(outcomes_ary, i,
+					LONG2NUM(((const long *) buf)[i]));
+}
+
+typedef struct {
+	randvar_t *rv;
+	void *buf;
+	long nr;
 	VALUE outcomes_ary;
-	long nr_times;
+} box_args_t;
+
+static VALUE fill_and_box_outcomes(VALUE arg)
+{
+	box_args_t *args = (box_args_t *) arg;
+
+	fill_outcomes(args->rv, args->buf, args->nr);
+	box_outcomes(args->outcomes_ary, args->rv, args->buf, args->nr);
+	return Qnil;
+}
+
+static VALUE free_buffer(VALUE arg)
+{
+	xfree(((box_args_t *) arg)->buf);
+	return Qnil;
+}
+
+/******************************************************************************/
+/* obtain several outcomes from the Ruby random variable object, they are
+   written over the elements of outcomes_ary unless it is nil */
+/******************************************************************************/
+VALUE rb_outcomes(VALUE rb_obj, VALUE rb_nr_times, VALUE outcomes_ary)
+{
+	randvar_t *rv = NULL;
+	long nr_times, i;
 	VALUE (*func)(randvar_t *);
 
 	nr_times = get_nr_times(rb_nr_times);
 	GET_DATA(rb_obj, rv);
 
+	if (NIL_P(outcomes_ary)) {
+		outcomes_ary = rb_ary_new_capa(nr_times);
+	} else {
+		Check_Type(outcomes_ary, T_ARRAY);
+		rb_ary_resize(outcomes_ary, nr_times);
+	}
+
+	/* expressions, mixtures and vectors are better evaluated a chunk at
+	   a time */
+	if ((nr_times >= PARALLEL_MIN && RANDVAR_REENTRANT(rv)) ||
+		rv_type_expression == RANDVAR_TYPE(rv) ||
+		rv_type_mixture == RANDVAR_TYPE(rv) ||
+		rv_type_multivariate_normal == RANDVAR_TYPE(rv)) {
+		box_args_t args;
+
+		args.rv = rv;
+		args.nr = nr_times;
+		args.outcomes_ary = outcomes_ary;
+		args.buf = xmalloc2(nr_times, randvar_width(rv) * 
+				KIND_SIZE(RANDVAR_KIND(rv)));
+		rb_ensure(fill_and_box_outcomes, (VALUE) &args, 
+				free_buffer, (VALUE) &args);
+		return outcomes_ary;
+	}
+
+	rv_gen_select(RANDVAR_GEN(rv));
 	func = outcome_func[RANDVAR_TYPE(rv)];	
-	for (outcomes_ary = rb_ary_new(); nr_times > 0; --nr_times) 
-		rb_ary_push(outcomes_ary, (*func)(rv));
+	for (i = 0; i < nr_times; i++)
+		rb_ary_store(outcomes_ary, i, (*func)(rv));
 	return outcomes_ary;
 }
+
+/******************************************************************************/
+/* obtain several outcomes packed as little-endian doubles or 64-bit integers
+   into a binary String or an IO::Buffer */
+/******************************************************************************/
+#define PACKED_SIZE	8
+#if SIZEOF_LONG == PACKED_SIZE && !defined(WORDS_BIGENDIAN)
+#define PACK_IN_PLACE	1
+#else
+#define PACK_IN_PLACE	0
+#endif
+
+typedef struct {
+	randvar_t *rv;
+	char *buf;
+	long nr;
+} pack_args_t;
+
+static VALUE pack_outcomes(VALUE arg)
+{
+	pack_args_t *args = (pack_args_t *) arg;
+	kind_t kind = RANDVAR_KIND(args->rv);
+	long nr_values = args->nr * randvar_width(args->rv);
+	char *tmp;
+	long i;
+	int b;
+
+	if (PACK_IN_PLACE && 0 == (uintptr_t) args->buf % PACKED_SIZE) {
+		fill_outcomes(args->rv, args->buf, args->nr);
+		return Qnil;
+	}
+
+	tmp = xmalloc2(nr_values, KIND_SIZE(kind));
+	fill_outcomes(args->rv, tmp, args->nr);
+	for (i = 0; i < nr_values; i++) {
+		uint64_t bits;
+
+		if (rv_kind_double == kind)
+			memcpy(&bits, &((double *) tmp)[i], sizeof(bits));
+		else
+			bits = (uint64_t) (int64_t) ((long *) tmp)[i];
+		for (b = 0; b < PACKED_SIZE; b++)
+			args->buf[i * PACKED_SIZE + b] = (char) (bits >> 8 * b);
+	}
+	xfree(tmp);
+	return Qnil;
+}
+
+static VALUE unlock_string(VALUE rb_str)
+{
+	return rb_str_unlocktmp(rb_str);
+}
+
+#ifdef HAVE_RUBY_IO_BUFFER_H
+static VALUE unlock_io_buffer(VALUE rb_io_buffer)
+{
+	return rb_io_buffer_unlock(rb_io_buffer);
+}
+#endif /* HAVE_RUBY_IO_BUFFER_H */
+
+VALUE rb_outcomes_packed(VALUE rb_obj, VALUE rb_nr_times, VALUE rb_buffer)
+{
+	pack_args_t args;
+	long size;
+
+	args.nr = get_nr_times(rb_nr_times);
+	GET_DATA(rb_obj, args.rv);
+
+	if (args.nr > LONG_MAX / PACKED_SIZE / randvar_width(args.rv))
+		rb_raise(rb_eArgError, "too many outcomes to be packed");
+	size = args.nr * randvar_width(args.rv) * PACKED_SIZE;
+
+	if (NIL_P(rb_buffer))
+		rb_buffer = rb_str_new(NULL, size);
+
+	if (RB_TYPE_P(rb_buffer, T_STRING)) {
+		rb_str_modify(rb_buffer);
+		rb_str_resize(rb_buffer, size);
+		rb_enc_associate(rb_buffer, rb_ascii8bit_encoding());
+		args.buf = RSTRING_PTR(rb_buffer);
+		rb_str_locktmp(rb_buffer);
+		rb_ensure(pack_outcomes, (VALUE) &args, 
+				unlock_string, rb_buffer);
+		return rb_buffer;
+	}
+
+#ifdef HAVE_RUBY_IO_BUFFER_H
+	if (rb_obj_is_kind_of(rb_buffer, rb_cIOBuffer)) {
+		void *base;
+		size_t buffer_size;
+
+		rb_io_buffer_get_bytes_for_writing(rb_buffer, 
+							&base, &buffer_size);
+		if (buffer_size < (size_t) size)
+			rb_raise(rb_eArgError, "buffer too small for "
+						"%ld outcomes", args.nr);
+		args.buf = base;
+		rb_io_buffer_lock(rb_buffer);
+		rb_ensure(pack_outcomes, (VALUE) &args, 
+				unlock_io_buffer, rb_buffer);
+		return rb_buffer;
+	}
+#endif /* HAVE_RUBY_IO_BUFFER_H */
+
+	rb_raise(rb_eTypeError, "the buffer must be a String or an IO::Buffer");
+}
+
+/* the type of each packed outcome */
+VALUE rb_packed_type(VALUE rb_obj)
+{
+	randvar_t *rv = NULL;
+
+	GET_DATA(rb_obj, rv);
+	if (rv_kind_double == RANDVAR_KIND(rv))
+		return ID2SYM(rb_intern("float64"));
+	return ID2SYM(rb_intern("int64"));
+}
+
+/******************************************************************************/
+/* outcomes of Bernoulli and Rademacher random variables as bits, taken 64 at
+   a time out of the words of the generator whatever the algorithm */
+/******************************************************************************/
+static inline uint64_t randvar_word(randvar_t *rv, rv_gen_t *gen)
+{
+	if (rv_type_rademacher == RANDVAR_TYPE(rv))
+		return rademacher_word(gen);
+	return bernoulli_word(rv->RANDVAR_DATA.bernoulli.threshold,
+				rv->RANDVAR_DATA.bernoulli.low, gen);
+}
+
+static inline long popcount64(uint64_t x)
+{
+#ifdef __GNUC__
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & UINT64_C(0x5555555555555555));
+	x = (x & UINT64_C(0x3333333333333333)) + 
+		((x >> 2) & UINT64_C(0x3333333333333333));
+	x = (x + (x >> 4)) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+	return (long) ((x * UINT64_C(0x0101010101010101)) >> 56);
+#endif
+}
+
+/* the jobs of these tasks deal with words of 64 outcomes */
+static void bits_task(randvar_t *rv, void *out, long nr)
+{
+	unsigned char *bytes = out;
+	rv_gen_t *gen = rv_gen_current();
+	uint64_t w;
+	long i;
+	int b;
+
+	for (i = 0; i < nr; i++) {
+		w = randvar_word(rv, gen);
+		for (b = 0; b < 8; b++)
+			bytes[8 * i + b] = (unsigned char) (w >> 8 * b);
+	}
+}
+
+static void count_task(randvar_t *rv, void *out, long nr)
+{
+	rv_gen_t *gen = rv_gen_current();
+	long i, count = 0;
+
+	for (i = 0; i < nr; i++)
+		count += popcount64(randvar_word(rv, gen));
+	*(long *) out += count;
+}
+
+/* the outcomes past the last whole word, drawn from the generator of rv */
+static uint64_t tail_word(randvar_t *rv, long nr)
+{
+	if (0 == nr % 64)
+		return 0;
+	rv_gen_select(RANDVAR_GEN(rv));
+	return randvar_word(rv, rv_gen_current()) & 
+		((UINT64_C(1) << nr % 64) - 1);
+}
+
+typedef struct {
+	randvar_t *rv;
+	VALUE rb_str;
+	long nr;
+} bits_args_t;
+
+static VALUE fill_bits(VALUE arg)
+{
+	bits_args_t *args = (bits_args_t *) arg;
+	unsigned char *bytes = (unsigned char *) RSTRING_PTR(args->rb_str);
+	long nr_words = args->nr / 64, i;
+	uint64_t w;
+
+	/* as fill_outcomes() does, few words are not worth a job */
+	if (nr_words >= PARALLEL_MIN) {
+		run_job(args->rv, nr_words, bits_task, (char *) bytes, 0, 8,
+							MAX_NR_PARTS);
+	} else {
+		rv_gen_select(RANDVAR_GEN(args->rv));
+		bits_task(args->rv, bytes, nr_words);
+	}
+	w = tail_word(args->rv, args->nr);
+	for (i = nr_words * 8; i < (args->nr + 7) / 8; i++, w >>= 8)
+		bytes[i] = (unsigned char) w;
+	return Qnil;
+}
+
+/* nr outcomes as a binary String, outcome i being bit i % 8 of byte i / 8,
+   which is set for a success or a +1 */
+VALUE rb_outcomes_bits(VALUE rb_obj, VALUE rb_nr_times)
+{
+	bits_args_t args;
+
+	args.nr = get_nr_times(rb_nr_times);
+	GET_DATA(rb_obj, args.rv);
+
+	args.rb_str = rb_str_new(NULL, (args.nr + 7) / 8);
+	rb_str_locktmp(args.rb_str);
+	rb_ensure(fill_bits, (VALUE) &args, unlock_string, args.rb_str);
+	return args.rb_str;
+}
+
+/* the number of successes or +1s among nr outcomes, which are not kept */
+VALUE rb_count_successes(VALUE rb_obj, VALUE rb_nr_times)
+{
+	randvar_t *rv = NULL;
+	long counts[MAX_NR_PARTS], nr, count, i;
+
+	nr = get_nr_times(rb_nr_times);
+	GET_DATA(rb_obj, rv);
+
+	for (i = 0; i < MAX_NR_PARTS; i++)
+		counts[i] = 0;
+	if (nr / 64 >= PARALLEL_MIN) {
+		run_job(rv, nr / 64, count_task, (char *) counts, 
+				sizeof(long), 0, MAX_NR_PARTS);
+	} else {
+		rv_gen_select(RANDVAR_GEN(rv));
+		count_task(rv, counts, nr / 64);
+	}
+	count = popcount64(tail_word(rv, nr));
+	for (i = 0; i < MAX_NR_PARTS; i++)
+		count += counts[i];
+	return LONG2NUM(count);
+}
+
+/******************************************************************************/
+/* the sum of many outcomes drawn at once out of its own distribution */
+/******************************************************************************/
+/* a single Gamma outcome, of the given shape and unit scale */
+static double gamma_once(double shape)
+{
+	gamma_setup_t st;
+
+	gamma_setup(&st, shape);
+	return gamma_sample(&st);
+}
+
+static long poisson_once(double mean)
+{
+	gen_poisson_ptrs_t st;
+
+	if (mean > LONG_MAX - 0.05 * LONG_MAX)
+		rb_raise(rb_eArgError, "the sum of the outcomes may overflow");
+	if (rv_algorithm_fast == rv_algorithm && mean >= POISSON_PTRS_MIN) {
+		gen_poisson_ptrs_setup(&st, mean);
+		return gen_poisson_ptrs(&st);
+	}
+	return ignpoi(mean);
+}
+
+/* n * m, both of them non-negative */
+static long checked_mul(long n, long m)
+{
+	if (0 != m && n > LONG_MAX / m)
+		rb_raise(rb_eArgError, "the sum of the outcomes may overflow");
+	return n * m;
+}
+
+/* Normal of n times the mean and n times the covariance */
+static VALUE multivariate_normal_sum_of(randvar_t *rv, double n)
+{
+	long p = randvar_multivariate_normal_p(rv), i;
+	const double *mean = randvar_multivariate_normal_parm(rv) + 1;
+	VALUE rb_tmp, rb_ary;
+	double *x;
+
+	x = ALLOCV_N(double, rb_tmp, p);
+	randvar_multivariate_normal_fill(rv, x, 1);
+	for (i = 0; i < p; i++)
+		x[i] = n * mean[i] + sqrt(n) * (x[i] - mean[i]);
+	rb_ary = vector_to_ary(x, p);
+	ALLOCV_END(rb_tmp);
+	return rb_ary;
+}
+
+/* nil unless the distribution of the sum has a closed form */
+VALUE rb_sum_of(VALUE rb_obj, VALUE rb_nr_times)
+{
+	randvar_t *rv = NULL;
+	double n;
+	long nr;
+
+	nr = get_nr_times(rb_nr_times);
+	GET_DATA(rb_obj, rv);
+	rv_gen_select(RANDVAR_GEN(rv));
+	n = (double) nr;
+
+	switch (RANDVAR_TYPE(rv)) {
+	case rv_type_bernoulli:
+		return LONG2NUM(ignbin(nr, randvar_bernoulli_p(rv)));
+	case rv_type_binomial:
+		return LONG2NUM(ignbin(checked_mul(nr, randvar_binomial_n(rv)),
+						randvar_binomial_p(rv)));
+	case rv_type_negative_binomial:
+		if (0 == nr)
+			return INT2FIX(0);
+		return LONG2NUM(ignnbn(checked_mul(nr, 
+					randvar_negative_binomial_r(rv)),
+				randvar_negative_binomial_p(rv)));
+	case rv_type_poisson:
+		if (0 == nr)
+			return INT2FIX(0);
+		return LONG2NUM(poisson_once(n * randvar_poisson_mean(rv)));
+	case rv_type_rademacher:
+		return LONG2NUM(2 * ignbin(nr, 0.5) - nr);
+	case rv_type_exponential:
+		if (0 == nr)
+			return DBL2NUM(0.0);
+		return DBL2NUM(randvar_exponential_mean(rv) * gamma_once(n));
+	case rv_type_gamma:
+		if (0 == nr)
+			return DBL2NUM(0.0);
+		return DBL2NUM(randvar_gamma_scale(rv) * 
+				gamma_once(n * randvar_gamma_shape(rv)));
+	case rv_type_chi_squared:
+		if (0 == nr)
+			return DBL2NUM(0.0);
+		return DBL2NUM(2.0 * gamma_once(n * randvar_chi_squared_k(rv) 
+									/ 2.0));
+	case rv_type_normal:
+		return DBL2NUM(n * randvar_normal_mu(rv) + 
+			randvar_normal_sigma(rv) * sqrt(n) * rv_snorm());
+	case rv_type_multivariate_normal:
+		return multivariate_normal_sum_of(rv, n);
+	default:
+		return Qnil;
+	}
+}
+
+/******************************************************************************/
+/* statistics of many outcomes, folded as they are drawn a chunk at a time so
+   that no more than a chunk of them is ever kept */
+/******************************************************************************/
+#define SUMMARY_CHUNK	1024L
+
+typedef struct {
+	rv_moments_t moments;
+	rv_value_t min, max;	/* of the kind of the outcomes */
+	rv_tdigest_t *digest;	/* NULL unless quantiles are wanted */
+	rv_histogram_t *histogram;	/* that of the worker, or NULL */
+} summary_t;
+
+/* the first outcome sets min and max, as in Samples#min and Samples#max */
+#define SUMMARY_MIN_MAX(summary, member, x, n, i)			\
+	do {								\
+		if (0 == (summary)->moments.n)				\
+			(summary)->min.member = 			\
+				(summary)->max.member = (x)[0];		\
+		for ((i) = 0; (i) < (n); (i)++) {			\
+			if ((x)[i] < (summary)->min.member)		\
+				(summary)->min.member = (x)[i];		\
+			if ((x)[i] > (summary)->max.member)		\
+				(summary)->max.member = (x)[i];		\
+		}							\
+	} while (0)
+
+static void summary_task(randvar_t *rv, void *out, long nr)
+{
+	summary_t *summary = out;
+	union {
+		double d[SUMMARY_CHUNK];
+		long l[SUMMARY_CHUNK];
+	} buf;
+	double x[SUMMARY_CHUNK];
+	long done, n, i;
+
+	for (done = 0; done < nr; done += n) {
+		n = (nr - done < SUMMARY_CHUNK) ? nr - done : SUMMARY_CHUNK;
+		(*fill_func[RANDVAR_TYPE(rv)])(rv, &buf, n);
+		if (rv_kind_long == RANDVAR_KIND(rv)) {
+			SUMMARY_MIN_MAX(summary, l, buf.l, n, i);
+			for (i = 0; i < n; i++)
+				x[i] = (double) buf.l[i];
+		} else {
+			SUMMARY_MIN_MAX(summary, d, buf.d, n, i);
+			for (i = 0; i < n; i++)
+				x[i] = buf.d[i];
+		}
+		rv_moments_add_n(&summary->moments, x, n);
+		if (NULL != summary->digest)
+			rv_tdigest_add_n(summary->digest, x, n);
+		if (NULL != summary->histogram)
+			rv_histogram_add_n(summary->histogram, x, n);
+	}
+}
+#undef SUMMARY_MIN_MAX
+
+/* b folded into a */
+static void summary_merge(randvar_t *rv, summary_t *a, summary_t *b)
+{
+	if (0 == b->moments.n)
+		return;
+	if (NULL != a->digest)
+		rv_tdigest_merge(a->digest, b->digest);
+	if (0 == a->moments.n) {
+		a->min = b->min;
+		a->max = b->max;
+	} else if (rv_kind_long == RANDVAR_KIND(rv)) {
+		if (b->min.l < a->min.l)
+			a->min.l = b->min.l;
+		if (b->max.l > a->max.l)
+			a->max.l = b->max.l;
+	} else {
+		if (b->min.d < a->min.d)
+			a->min.d = b->min.d;
+		if (b->max.d > a->max.d)
+			a->max.d = b->max.d;
+	}
+	rv_moments_merge(&a->moments, &b->moments);
+}
+
+static VALUE summary_value(randvar_t *rv, const summary_t *summary,
+							rv_value_t v)
+{
+	if (0 == summary->moments.n)
+		return Qnil;
+	if (rv_kind_long == RANDVAR_KIND(rv))
+		return LONG2NUM(v.l);
+	return DBL2NUM(v.d);
+}
+
+typedef struct {
+	randvar_t *rv;
+	long nr;
+	double compression;	/* NaN unless quantiles are wanted */
+	/* NULL unless binned counts are wanted */
+	rv_histogram_t *histogram;
+	summary_t summaries[MAX_NR_PARTS];
+	rv_histogram_t *histograms[MAX_NR_THREADS];
+	VALUE rb_digest;
+} summarize_args_t;
+
+/* no more memory than this is taken by the t-digests of the parts */
+#define SUMMARY_DIGESTS_SIZE	(64L << 20)
+
+static VALUE summarize_run(VALUE arg)
+{
+	summarize_args_t *args = (summarize_args_t *) arg;
+	summary_t *summaries = args->summaries;
+	randvar_t *rv = args->rv;
+	long max_parts = MAX_NR_PARTS, nr_workers, done, n, i;
+
+	/* a t-digest for every part, folded in order so that the result
+	   does not depend on the number of threads */
+	if (!isnan(args->compression)) {
+		max_parts = SUMMARY_DIGESTS_SIZE / 
+				rv_tdigest_size(args->compression);
+		if (max_parts > MAX_NR_PARTS)
+			max_parts = MAX_NR_PARTS;
+		for (i = 0; i < job_nr_parts(args->nr, max_parts); i++)
+			summaries[i].digest = rv_tdigest_alloc(
+							args->compression);
+	}
+	/* and a histogram of the same layout for every worker, the counts
+	   of all of them being added up at the end */
+	nr_workers = job_nr_workers(args->nr, max_parts);
+	if (NULL != args->histogram) {
+		for (i = 0; i < nr_workers; i++)
+			args->histograms[i] = 
+				rv_histogram_alloc_like(args->histogram);
+		for (i = 0; i < MAX_NR_PARTS; i++)
+			summaries[i].histogram = 
+					args->histograms[i % nr_workers];
+	}
+
+	/* as fill_outcomes() does, few outcomes are not worth a job */
+	if (args->nr >= PARALLEL_MIN && RANDVAR_REENTRANT(rv)) {
+		run_job(rv, args->nr, summary_task, (char *) summaries,
+					sizeof(summary_t), 0, max_parts);
+	} else {
+		/* with the GVL, checking for interrupts now and then */
+		rv_gen_select(RANDVAR_GEN(rv));
+		for (done = 0; done < args->nr; done += n) {
+			n = (args->nr - done < PARALLEL_CHUNK) ? 
+					args->nr - done : PARALLEL_CHUNK;
+			summary_task(rv, &summaries[0], n);
+			rb_thread_check_ints();
+			rv_gen_select(RANDVAR_GEN(rv));
+		}
+	}
+	for (i = 1; i < MAX_NR_PARTS; i++)
+		summary_merge(rv, &summaries[0], &summaries[i]);
+
+	if (NULL != summaries[0].digest) {
+		args->rb_digest = rv_tdigest_wrap(summaries[0].digest);
+		summaries[0].digest = NULL;
+	}
+	if (NULL != args->histogram)
+		for (i = 0; i < nr_workers; i++)
+			rv_histogram_merge(args->histogram, 
+						args->histograms[i]);
+	return Qnil;
+}
+
+static VALUE summarize_free(VALUE arg)
+{
+	summarize_args_t *args = (summarize_args_t *) arg;
+	long i;
+
+	for (i = 0; i < MAX_NR_PARTS; i++)
+		if (NULL != args->summaries[i].digest)
+			rv_tdigest_free(args->summaries[i].digest);
+	for (i = 0; i < MAX_NR_THREADS; i++)
+		if (NULL != args->histograms[i])
+			rv_histogram_free(args->histograms[i]);
+	return Qnil;
+}
+
+/* [moments, min, max, t-digest] of nr outcomes, the t-digest being nil
+   unless a compression is given; each part of the job folds its own
+   outcomes, the results of the parts being merged in order.  The outcomes
+   are also counted into rb_histogram, a RandomVariable::Histogram, unless
+   it is nil.  It raises ArgumentError unless the outcomes are numbers */
+VALUE rb_summarize(VALUE rb_obj, VALUE rb_nr_times, VALUE rb_compression,
+							VALUE rb_histogram)
+{
+	summarize_args_t args;
+	summary_t *summary = &args.summaries[0];
+	long i;
+
+	args.nr = get_nr_times(rb_nr_times);
+	GET_DATA(rb_obj, args.rv);
+	if (NULL == native_randvar(rb_obj))
+		rb_raise(rb_eArgError, "the outcomes of the random variable "
+						"are not scalars");
+	/* checked before NaN comes to stand for no t-digest */
+	args.compression = NAN;
+	if (!NIL_P(rb_compression)) {
+		args.compression = NUM2DBL(rb_compression);
+		rv_tdigest_check(args.compression);
+	}
+	args.histogram = NIL_P(rb_histogram) ? 
+				NULL : rv_histogram_get(rb_histogram);
+	args.rb_digest = Qnil;
+
+	expression_compile(args.rv);
+	for (i = 0; i < MAX_NR_PARTS; i++) {
+		rv_moments_init(&args.summaries[i].moments);
+		args.summaries[i].digest = NULL;
+		args.summaries[i].histogram = NULL;
+	}
+	for (i = 0; i < MAX_NR_THREADS; i++)
+		args.histograms[i] = NULL;
+	rb_ensure(summarize_run, (VALUE) &args, summarize_free, (VALUE) &args);
+
+	return rb_ary_new3(4, rv_moments_new(&summary->moments),
+			summary_value(args.rv, summary, summary->min),
+			summary_value(args.rv, summary, summary->max),
+			args.rb_digest);
+}
+
+/******************************************************************************/
+/* get and set the number of native threads outcomes are generated by */
+/******************************************************************************/
+static VALUE rb_threads_get(VALUE self)
+{
+	return LONG2NUM(nr_threads);
+}
+
+static VALUE rb_threads_set(VALUE self, VALUE rb_nr_threads)
+{
+	long nr = NUM2LONG(rb_nr_threads);
+
+	if (nr < 1 || nr > MAX_NR_THREADS)
+		rb_raise(rb_eArgError, "the number of threads must be "
+					"between 1 and %ld", MAX_NR_THREADS);
+	nr_threads = nr;
+	return rb_nr_threads;
+}
+
+/******************************************************************************/
+/* get and set the algorithms used by the samplers */
+/******************************************************************************/
+static VALUE rb_algorithm_get(VALUE self)
+{
+	if (rv_algorithm_classic == rv_algorithm)
+		return ID2SYM(rb_intern("classic"));
+	return ID2SYM(rb_intern("fast"));
+}
+
+static VALUE rb_algorithm_set(VALUE self, VALUE rb_algorithm)
+{
+	if (ID2SYM(rb_intern("fast")) == rb_algorithm)
+		rv_algorithm = rv_algorithm_fast;
+	else if (ID2SYM(rb_intern("classic")) == rb_algorithm)
+		rv_algorithm = rv_algorithm_classic;
+	else
+		rb_raise(rb_eArgError, "unknown algorithm, "
+					"either :fast or :classic");
+	return rb_algorithm;
+}
+
+static long default_nr_threads(void)
+{
+	long nr = 1;
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+	nr = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (nr < 1)
+		nr = 1;
+	if (nr > MAX_NR_THREADS)
+		nr = MAX_NR_THREADS;
+	return nr;
+}
+
+/******************************************************************************/
+/* get and set the generator the outcomes are drawn from */
+/******************************************************************************/
+VALUE rb_generator_get(VALUE rb_obj)
+{
+	randvar_t *rv = NULL;
+
+	GET_DATA(rb_obj, rv);
+	if (NULL == RANDVAR_GEN(rv))
+		return rv_gen_default();
+	return rv->rb_gen;
+}
+
+VALUE rb_generator_set(VALUE rb_obj, VALUE rb_gen)
+{
+	randvar_t *rv = NULL;
+	rv_gen_t *gen;
+
+	GET_DATA(rb_obj, rv);
+	if (NIL_P(rb_gen) || rb_gen == rv_gen_default()) {
+		gen = NULL;
+		rb_gen = Qnil;
+	} else {
+		/* it raises TypeError if not a generator */
+		gen = rv_gen_get(rb_gen);
+	}
+	RANDVAR_GEN(rv) = gen;
+	rv->rb_gen = rb_gen;
+	return rb_gen;
+}
 #undef GET_DATA
 
 /******************************************************************************/
@@ -777,19 +3012,108 @@ VALUE rb_outcomes(VALUE rb_obj, VALUE rb_nr_times)
 /******************************************************************************/
 static VALUE rb_seed_new(VALUE self)
 {
-	return rv_gen_new_seed();		
+	return rv_gen_new_seed(self);
 }
 
 static VALUE rb_seed_get(VALUE self)
 {
-	return rv_gen_get_seed();
+	return rv_gen_get_seed(self);
 }
 
 static VALUE rb_seed_set(VALUE self, VALUE rb_seed)
 {
-	rv_gen_set_seed(rb_seed);
+	rv_gen_set_seed(self, rb_seed);
 	return rb_seed;
 }
+
+static VALUE rb_gen_initialize(int argc, VALUE *argv, VALUE self)
+{
+	VALUE rb_seed;
+
+	rb_scan_args(argc, argv, "01", &rb_seed);
+	if (NIL_P(rb_seed))
+		rv_gen_new_seed(self);
+	else
+		rv_gen_set_seed(self, rb_seed);
+	return self;
+}
+
+static VALUE rb_gen_rand(VALUE self)
+{
+	rv_gen_select(rv_gen_get(self));
+	return DBL2NUM(ranf());
+}
+
+static VALUE rb_gen_initialize_copy(VALUE self, VALUE rb_orig)
+{
+	if (self != rb_orig)
+		rv_gen_copy(self, rb_orig);
+	return self;
+}
+
+static VALUE rb_gen_jump(VALUE self)
+{
+	rv_gen_jump(rv_gen_get(self));
+	return self;
+}
+
+static VALUE rb_gen_long_jump(VALUE self)
+{
+	rv_gen_long_jump(rv_gen_get(self));
+	return self;
+}
+
+static VALUE rb_gen_split(VALUE self, VALUE rb_nr_streams)
+{
+	VALUE rb_streams;
+	long nr_streams;
+
+	nr_streams = NUM2LONG(rb_nr_streams);
+	if (nr_streams < 0)
+		rb_raise(rb_eArgError,
+			"the number of streams cannot be negative");
+
+	rb_streams = rb_ary_new_capa(nr_streams);
+	for (; nr_streams > 0; --nr_streams)
+		rb_ary_push(rb_streams, rv_gen_split(self));
+	return rb_streams;
+}
+
+static VALUE rb_gen_marshal_dump(VALUE self)
+{
+	return rb_assoc_new(rv_gen_get_seed(self), rv_gen_get_state(self));
+}
+
+static VALUE rb_gen_marshal_load(VALUE self, VALUE rb_dump)
+{
+	Check_Type(rb_dump, T_ARRAY);
+	if (2 != RARRAY_LEN(rb_dump))
+		rb_raise(rb_eArgError, "wrong generator dump");
+	rv_gen_restore(self, rb_ary_entry(rb_dump, 0),
+			rb_ary_entry(rb_dump, 1));
+	return self;
+}
+
+/* the singleton methods act on the default generator */
+static VALUE rb_default_seed_new(VALUE self)
+{
+	return rb_seed_new(rv_gen_default());
+}
+
+static VALUE rb_default_seed_get(VALUE self)
+{
+	return rb_seed_get(rv_gen_default());
+}
+
+static VALUE rb_default_seed_set(VALUE self, VALUE rb_seed)
+{
+	return rb_seed_set(rv_gen_default(), rb_seed);
+}
+
+static VALUE rb_default_gen(VALUE self)
+{
+	return rv_gen_default();
+}
 /******************************************************************************/
 
 
@@ -816,10 +3140,31 @@ static VALUE rb_seed_set(VALUE self, VALUE rb_seed)
 			"intern_outcome", rb_outcome, 0);		\
 									\
 		rb_define_private_method(*rb_objp,			\
-			"intern_outcomes", rb_outcomes, 1);		\
+			"intern_outcomes", rb_outcomes, 2);		\
+									\
+		rb_define_private_method(*rb_objp,			\
+			"intern_outcomes_packed", rb_outcomes_packed, 2);\
+									\
+		rb_define_private_method(*rb_objp,			\
+			"intern_sum_of", rb_sum_of, 1);			\
+									\
+		rb_define_private_method(*rb_objp,			\
+			"intern_summarize", rb_summarize, 3);		\
+									\
+		rb_define_method(*rb_objp, "packed_type",		\
+			rb_packed_type, 0);				\
+									\
+		rb_define_method(*rb_objp, "generator",			\
+			rb_generator_get, 0);				\
+									\
+		rb_define_method(*rb_objp, "generator=",		\
+			rb_generator_set, 1);				\
 									\
 		outcome_func[rv_type_ ##name] = 			\
 				randvar_ ##name ##_rb_outcome;		\
+		fill_func[rv_type_ ##name] = randvar_ ##name ##_fill;	\
+		outcome_kind[rv_type_ ##name] = rv_ ##name ##_kind;	\
+		reentrant[rv_type_ ##name] = rv_ ##name ##_reentrant;	\
 	} while (0)
 
 /******************************************************************************/
@@ -829,12 +3174,39 @@ void Init_random_variable(void)
 {
 	/* the RandomVariable module */
 	rb_mRandomVariable = rb_define_module("RandomVariable");
+	rb_define_singleton_method(rb_mRandomVariable, "threads",
+						rb_threads_get, 0);
+	rb_define_singleton_method(rb_mRandomVariable, "threads=",
+						rb_threads_set, 1);
+	nr_threads = default_nr_threads();
+	rb_define_singleton_method(rb_mRandomVariable, "algorithm",
+						rb_algorithm_get, 0);
+	rb_define_singleton_method(rb_mRandomVariable, "algorithm=",
+						rb_algorithm_set, 1);
 
 	/* Generator */
-	rb_mGenerator = rb_define_module_under(rb_mRandomVariable, "Generator");
-	rb_define_singleton_method(rb_mGenerator, "new_seed", rb_seed_new, 0);
-	rb_define_singleton_method(rb_mGenerator, "seed", rb_seed_get, 0);
-	rb_define_singleton_method(rb_mGenerator, "seed=", rb_seed_set, 1);
+	rb_cGenerator = rb_define_class_under(rb_mRandomVariable,
+						"Generator", rb_cObject);
+	rb_define_alloc_func(rb_cGenerator, rv_gen_alloc);
+	rb_define_method(rb_cGenerator, "initialize", rb_gen_initialize, -1);
+	rb_define_method(rb_cGenerator, "new_seed", rb_seed_new, 0);
+	rb_define_method(rb_cGenerator, "seed", rb_seed_get, 0);
+	rb_define_method(rb_cGenerator, "seed=", rb_seed_set, 1);
+	rb_define_method(rb_cGenerator, "rand", rb_gen_rand, 0);
+	rb_define_method(rb_cGenerator, "initialize_copy",
+						rb_gen_initialize_copy, 1);
+	rb_define_method(rb_cGenerator, "jump", rb_gen_jump, 0);
+	rb_define_method(rb_cGenerator, "long_jump", rb_gen_long_jump, 0);
+	rb_define_method(rb_cGenerator, "split", rb_gen_split, 1);
+	rb_define_method(rb_cGenerator, "marshal_dump", rb_gen_marshal_dump, 0);
+	rb_define_method(rb_cGenerator, "marshal_load", rb_gen_marshal_load, 1);
+	rb_define_singleton_method(rb_cGenerator, "default", rb_default_gen, 0);
+	rb_define_singleton_method(rb_cGenerator, "new_seed",
+						rb_default_seed_new, 0);
+	rb_define_singleton_method(rb_cGenerator, "seed",
+						rb_default_seed_get, 0);
+	rb_define_singleton_method(rb_cGenerator, "seed=",
+						rb_default_seed_set, 1);
 
 	/* Generic */
 	rb_cRandomVariables[rv_type_generic] = 
@@ -844,11 +3216,17 @@ void Init_random_variable(void)
 	CREATE_RANDOM_VARIABLE_CLASS("Bernoulli", bernoulli);
 	CREATE_RANDOM_VARIABLE_CLASS("Beta", beta);
 	CREATE_RANDOM_VARIABLE_CLASS("Binomial", binomial);
+	CREATE_RANDOM_VARIABLE_CLASS("Categorical", categorical);
 	CREATE_RANDOM_VARIABLE_CLASS("ChiSquared", chi_squared);
 	CREATE_RANDOM_VARIABLE_CLASS("ContinuousUniform", continuous_uniform);
 	CREATE_RANDOM_VARIABLE_CLASS("DiscreteUniform", discrete_uniform);
 	CREATE_RANDOM_VARIABLE_CLASS("Exponential", exponential);
+	CREATE_RANDOM_VARIABLE_CLASS("Expression", expression);
 	CREATE_RANDOM_VARIABLE_CLASS("F", f);
+	CREATE_RANDOM_VARIABLE_CLASS("Gamma", gamma);
+	CREATE_RANDOM_VARIABLE_CLASS("Mixture", mixture);
+	CREATE_RANDOM_VARIABLE_CLASS("MultivariateNormal", 
+						multivariate_normal);
 	CREATE_RANDOM_VARIABLE_CLASS("NegativeBinomial", negative_binomial);
 	CREATE_RANDOM_VARIABLE_CLASS("Normal", normal);
 	CREATE_RANDOM_VARIABLE_CLASS("Pareto", pareto);
@@ -857,8 +3235,26 @@ void Init_random_variable(void)
 	CREATE_RANDOM_VARIABLE_CLASS("Rayleigh", rayleigh);
 	CREATE_RANDOM_VARIABLE_CLASS("Rectangular", rectangular);
 
+	/* outcomes as bits */
+	rb_define_method(rb_cRandomVariables[rv_type_bernoulli], 
+			"outcomes_bits", rb_outcomes_bits, 1);
+	rb_define_method(rb_cRandomVariables[rv_type_bernoulli], 
+			"count_successes", rb_count_successes, 1);
+	rb_define_method(rb_cRandomVariables[rv_type_rademacher], 
+			"outcomes_bits", rb_outcomes_bits, 1);
+	rb_define_method(rb_cRandomVariables[rv_type_rademacher], 
+			"count_successes", rb_count_successes, 1);
+
+	/* expressions sharing the outcomes of a joint draw */
+	rb_define_private_method(rb_cRandomVariables[rv_type_expression],
+		"intern_joint_outcome", rb_expression_joint_outcome, 0);
+
+	/* statistics of the outcomes */
+	rv_init_samples(rb_mRandomVariable);
+
 	/* initialize the random number generator */
-	rv_init_gen();
+	rv_init_gen(rb_cGenerator);
+	rv_init_ziggurat();
 }
 #undef CREATE_RANDOM_VARIABLE_CLASS
 
@@ -0,0 +1,978 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     samples.c                                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/02/16                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+    random_variable gem for the creation or random variables in Ruby
+    Copyright (C) 2012 Jorge Fco. Madronal Rinaldi
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+
+#include <ruby.h>
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#else
+#error "No math.h header found"
+#endif /* HAVE_MATH_H */
+
+#include <stdlib.h>
+
+#include "samples.h"
+
+/* the statistics of the RandomVariable::Samples module, worked out over the
+   elements of the array itself: tight loops over native values whenever all
+   of them are Floats or all of them are Fixnums, Ruby's own operators
+   otherwise */
+typedef enum {
+	samples_double = 0,
+	samples_long,
+	samples_generic
+} samples_kind_t;
+
+/* self, RandomVariable::Samples being meant to extend Arrays alone */
+static inline VALUE samples_ary(VALUE self)
+{
+	Check_Type(self, T_ARRAY);
+	return self;
+}
+
+static samples_kind_t samples_kind(const VALUE *v, long n)
+{
+	long i;
+
+	if (n > 0 && FIXNUM_P(v[0])) {
+		for (i = 1; i < n; i++)
+			if (!FIXNUM_P(v[i]))
+				return samples_generic;
+		return samples_long;
+	}
+	for (i = 0; i < n; i++)
+		if (!RB_FLOAT_TYPE_P(v[i]))
+			return samples_generic;
+	return samples_double;
+}
+
+/******************************************************************************/
+/* max and min, the first of the extreme samples as Ruby's > and < tell */
+/******************************************************************************/
+#define CREATE_SAMPLES_EXTREME(name, op)				\
+	static VALUE rb_samples_ ##name(VALUE self)			\
+	{								\
+		const VALUE *v = RARRAY_CONST_PTR(samples_ary(self));	\
+		long n = RARRAY_LEN(self), i, best = 0;			\
+									\
+		if (0 == n)						\
+			return Qnil;					\
+		switch (samples_kind(v, n)) {				\
+		case samples_double:					\
+			for (i = 1; i < n; i++)				\
+				if (RFLOAT_VALUE(v[i]) op 		\
+					RFLOAT_VALUE(v[best]))		\
+					best = i;			\
+			break;						\
+		case samples_long:					\
+			for (i = 1; i < n; i++)				\
+				if (FIX2LONG(v[i]) op FIX2LONG(v[best]))\
+					best = i;			\
+			break;						\
+		default:						\
+			for (i = 1; i < RARRAY_LEN(self); i++)		\
+				if (RTEST(rb_funcall(rb_ary_entry(	\
+					self, i), rb_intern(#op), 1,	\
+					rb_ary_entry(self, best))))	\
+					best = i;			\
+			break;						\
+		}							\
+		return rb_ary_entry(self, best);			\
+	}
+
+CREATE_SAMPLES_EXTREME(max, >)
+CREATE_SAMPLES_EXTREME(min, <)
+#undef CREATE_SAMPLES_EXTREME
+
+/******************************************************************************/
+/* mean, summed up in order as a Float */
+/******************************************************************************/
+static VALUE rb_samples_mean(VALUE self)
+{
+	const VALUE *v = RARRAY_CONST_PTR(samples_ary(self));
+	long n = RARRAY_LEN(self), i;
+	double acc = 0.0;
+
+	if (0 == n)
+		return Qnil;
+	switch (samples_kind(v, n)) {
+	case samples_double:
+		for (i = 0; i < n; i++)
+			acc += RFLOAT_VALUE(v[i]);
+		break;
+	case samples_long:
+		for (i = 0; i < n; i++)
+			acc += (double) FIX2LONG(v[i]);
+		break;
+	default:
+		for (i = 0; i < RARRAY_LEN(self); i++)
+			acc += NUM2DBL(rb_ary_entry(self, i));
+		break;
+	}
+	return DBL2NUM(acc / n);
+}
+
+/******************************************************************************/
+/* median, by introselect over a copy of the samples: quickselect with a
+   median of three pivot, the rest of the range being sorted if it fails to
+   shrink fast enough */
+/******************************************************************************/
+#define CREATE_SAMPLES_SELECT(name, type)				\
+	static int cmp_ ##name(const void *a, const void *b)		\
+	{								\
+		type x = *(const type *) a, y = *(const type *) b;	\
+									\
+		return (x > y) - (x < y);				\
+	}								\
+									\
+	/* v[k] ends up being the k-th smallest, none of the 	\
+	   previous ones being greater */				\
+	static void select_ ##name(type *v, long n, long k)		\
+	{								\
+		long lo = 0, hi = n - 1, mid, i, j;			\
+		int depth = 0;						\
+		type pivot, t;						\
+									\
+		for (i = n; i > 1; i >>= 1)				\
+			depth += 2;					\
+		while (hi > lo) {					\
+			if (depth-- <= 0) {				\
+				qsort(v + lo, hi - lo + 1, 		\
+					sizeof(type), cmp_ ##name);	\
+				return;					\
+			}						\
+			mid = lo + (hi - lo) / 2;			\
+			if (v[mid] < v[lo]) 				\
+				t = v[mid], v[mid] = v[lo], v[lo] = t;	\
+			if (v[hi] < v[lo])				\
+				t = v[hi], v[hi] = v[lo], v[lo] = t;	\
+			if (v[hi] < v[mid])				\
+				t = v[hi], v[hi] = v[mid], v[mid] = t;	\
+			pivot = v[mid];					\
+			for (i = lo, j = hi; i <= j; ) {		\
+				while (v[i] < pivot)			\
+					i++;				\
+				while (v[j] > pivot)			\
+					j--;				\
+				if (i <= j) {				\
+					t = v[i], v[i] = v[j], v[j] = t;\
+					i++;				\
+					j--;				\
+				}					\
+			}						\
+			if (k <= j)					\
+				hi = j;					\
+			else if (k >= i)				\
+				lo = i;					\
+			else						\
+				return;					\
+		}							\
+	}								\
+									\
+	static type max_ ##name(const type *v, long n)			\
+	{								\
+		type m = v[0];						\
+		long i;							\
+									\
+		for (i = 1; i < n; i++)					\
+			if (v[i] > m)					\
+				m = v[i];				\
+		return m;						\
+	}
+
+CREATE_SAMPLES_SELECT(double, double)
+CREATE_SAMPLES_SELECT(long, long)
+#undef CREATE_SAMPLES_SELECT
+
+/* the median by sorting, as it used to be done */
+static VALUE generic_median(VALUE self)
+{
+	VALUE ary = rb_ary_sort(self);
+	long i = RARRAY_LEN(ary) / 2;
+
+	if (RARRAY_LEN(ary) % 2)
+		return rb_ary_entry(ary, i);
+	return rb_funcall(rb_funcall(rb_ary_entry(ary, i), rb_intern("+"), 1,
+				rb_ary_entry(ary, i - 1)), rb_intern("/"), 1, 
+				DBL2NUM(2.0));
+}
+
+static VALUE rb_samples_median(VALUE self)
+{
+	const VALUE *v = RARRAY_CONST_PTR(samples_ary(self));
+	long n = RARRAY_LEN(self), k = n / 2, i;
+	VALUE rb_tmp, rb_median;
+
+	if (0 == n)
+		return Qnil;
+	if (1 == n)
+		return v[0];
+
+	switch (samples_kind(v, n)) {
+	case samples_double: {
+		double *x = ALLOCV_N(double, rb_tmp, n);
+
+		for (i = 0; i < n; i++)
+			if (isnan(x[i] = RFLOAT_VALUE(v[i])))
+				break;
+		/* they cannot be sorted */
+		if (i < n) {
+			ALLOCV_END(rb_tmp);
+			return generic_median(self);
+		}
+		select_double(x, n, k);
+		if (n % 2)
+			rb_median = DBL2NUM(x[k]);
+		else
+			rb_median = DBL2NUM((x[k] + max_double(x, k)) / 2.0);
+		ALLOCV_END(rb_tmp);
+		return rb_median;
+	}
+	case samples_long: {
+		long *x = ALLOCV_N(long, rb_tmp, n);
+
+		for (i = 0; i < n; i++)
+			x[i] = FIX2LONG(v[i]);
+		select_long(x, n, k);
+		/* the sum of two Fixnums fits in a long */
+		if (n % 2)
+			rb_median = LONG2FIX(x[k]);
+		else
+			rb_median = DBL2NUM((double) (x[k] + max_long(x, k)) 
+									/ 2.0);
+		ALLOCV_END(rb_tmp);
+		return rb_median;
+	}
+	default:
+		return generic_median(self);
+	}
+}
+
+
+/******************************************************************************/
+/* the first four moments, updated one sample at a time as Welford and
+   Terriberry do or merged with those of another block as Pebay does:
+
+   Pebay, P. "Formulas for Robust, One-Pass Parallel Computation of
+   Covariances and Arbitrary-Order Statistical Moments." Sandia Report
+   SAND2008-6212, 2008. */
+/******************************************************************************/
+void rv_moments_init(rv_moments_t *m)
+{
+	m->n = 0;
+	m->mean = m->m2 = m->m3 = m->m4 = 0.0;
+}
+
+void rv_moments_add(rv_moments_t *m, double x)
+{
+	double n1 = (double) m->n, n, delta, delta_n, delta_n2, term;
+
+	n = (double) ++m->n;
+	delta = x - m->mean;
+	delta_n = delta / n;
+	delta_n2 = delta_n * delta_n;
+	term = delta * delta_n * n1;
+	m->mean += delta_n;
+	m->m4 += term * delta_n2 * (n * n - 3.0 * n + 3.0) + 
+			6.0 * delta_n2 * m->m2 - 4.0 * delta_n * m->m3;
+	m->m3 += term * delta_n * (n - 2.0) - 3.0 * delta_n * m->m2;
+	m->m2 += term;
+}
+
+void rv_moments_merge(rv_moments_t *a, const rv_moments_t *b)
+{
+	double na = (double) a->n, nb = (double) b->n, n, d, d2;
+
+	if (0 == b->n)
+		return;
+	if (0 == a->n) {
+		*a = *b;
+		return;
+	}
+	n = na + nb;
+	d = b->mean - a->mean;
+	d2 = d * d;
+	a->m4 += b->m4 + d2 * d2 * na * nb * (na * na - na * nb + nb * nb) /
+				(n * n * n) +
+		6.0 * d2 * (na * na * b->m2 + nb * nb * a->m2) / (n * n) +
+		4.0 * d * (na * b->m3 - nb * a->m3) / n;
+	a->m3 += b->m3 + d2 * d * na * nb * (na - nb) / (n * n) +
+		3.0 * d * (na * b->m2 - nb * a->m2) / n;
+	a->m2 += b->m2 + d2 * na * nb / n;
+	a->mean += d * nb / n;
+	a->n += b->n;
+}
+
+/* the samples are taken a block at a time: its moments are worked out by
+   two passes over the block, while it is in the cache, and then merged */
+#define MOMENTS_BLOCK	1024L
+
+void rv_moments_add_n(rv_moments_t *m, const double *x, long nr)
+{
+	rv_moments_t block;
+	double sum, d, d2;
+	long b, n, i;
+
+	for (b = 0; b < nr; b += MOMENTS_BLOCK) {
+		n = (nr - b < MOMENTS_BLOCK) ? nr - b : MOMENTS_BLOCK;
+		for (sum = 0.0, i = 0; i < n; i++)
+			sum += x[b + i];
+		block.n = n;
+		block.mean = sum / n;
+		block.m2 = block.m3 = block.m4 = 0.0;
+		for (i = 0; i < n; i++) {
+			d = x[b + i] - block.mean;
+			d2 = d * d;
+			block.m2 += d2;
+			block.m3 += d2 * d;
+			block.m4 += d2 * d2;
+		}
+		rv_moments_merge(m, &block);
+	}
+}
+
+/******************************************************************************/
+/* the RandomVariable::Moments class, moments accumulated so far */
+/******************************************************************************/
+static VALUE rb_cMoments = Qnil;
+
+static VALUE rb_moments_alloc(VALUE klass)
+{
+	rv_moments_t *m;
+	VALUE rb_moments;
+
+	rb_moments = Data_Make_Struct(klass, rv_moments_t, NULL, xfree, m);
+	rv_moments_init(m);
+	return rb_moments;
+}
+
+#define GET_MOMENTS(rb_obj, m)						\
+	do {								\
+		if (!rb_obj_is_kind_of((rb_obj), rb_cMoments))		\
+			rb_raise(rb_eTypeError, "not a "		\
+				"RandomVariable::Moments object");	\
+		Data_Get_Struct((rb_obj), rv_moments_t, (m));		\
+	} while (0)
+
+VALUE rv_moments_new(const rv_moments_t *m)
+{
+	rv_moments_t *dst;
+	VALUE rb_moments = rb_moments_alloc(rb_cMoments);
+
+	Data_Get_Struct(rb_moments, rv_moments_t, dst);
+	*dst = *m;
+	return rb_moments;
+}
+
+static VALUE rb_moments_initialize_copy(VALUE self, VALUE orig)
+{
+	rv_moments_t *dst, *src;
+
+	GET_MOMENTS(self, dst);
+	GET_MOMENTS(orig, src);
+	*dst = *src;
+	return self;
+}
+
+static VALUE rb_moments_add(VALUE self, VALUE rb_x)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	rv_moments_add(m, NUM2DBL(rb_x));
+	return self;
+}
+
+/* up to SAMPLES_BLOCK elements of ary, from the b-th one on, into x as
+   doubles; it returns how many of them */
+#define SAMPLES_BLOCK	1024L
+
+static long ary_block(VALUE ary, long b, double *x)
+{
+	long n = RARRAY_LEN(ary) - b, i;
+	VALUE v;
+
+	if (n > SAMPLES_BLOCK)
+		n = SAMPLES_BLOCK;
+	for (i = 0; i < n; i++) {
+		/* NUM2DBL may call back into Ruby, which may change the
+		   array */
+		v = rb_ary_entry(ary, b + i);
+		if (RB_FLOAT_TYPE_P(v))
+			x[i] = RFLOAT_VALUE(v);
+		else if (FIXNUM_P(v))
+			x[i] = (double) FIX2LONG(v);
+		else
+			x[i] = NUM2DBL(v);
+	}
+	return (n > 0) ? n : 0;
+}
+
+static void moments_add_ary(rv_moments_t *m, VALUE ary)
+{
+	double x[SAMPLES_BLOCK];
+	long n, b;
+
+	Check_Type(ary, T_ARRAY);
+	for (b = 0; (n = ary_block(ary, b, x)) > 0; b += n)
+		rv_moments_add_n(m, x, n);
+}
+
+static VALUE rb_moments_concat(VALUE self, VALUE ary)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	moments_add_ary(m, ary);
+	return self;
+}
+
+static VALUE rb_moments_merge_bang(VALUE self, VALUE other)
+{
+	rv_moments_t *a, *b;
+
+	GET_MOMENTS(self, a);
+	GET_MOMENTS(other, b);
+	rv_moments_merge(a, b);
+	return self;
+}
+
+static VALUE rb_moments_merge(VALUE self, VALUE other)
+{
+	return rb_moments_merge_bang(rb_obj_dup(self), other);
+}
+
+static VALUE rb_moments_count(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	return LONG2NUM(m->n);
+}
+
+/* nil below the number of samples each statistic needs */
+static VALUE rb_moments_mean(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	if (m->n < 1)
+		return Qnil;
+	return DBL2NUM(m->mean);
+}
+
+/* unbiased, dividing by n - 1 */
+static VALUE rb_moments_variance(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	if (m->n < 2)
+		return Qnil;
+	return DBL2NUM(m->m2 / (m->n - 1));
+}
+
+static VALUE rb_moments_stddev(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	if (m->n < 2)
+		return Qnil;
+	return DBL2NUM(sqrt(m->m2 / (m->n - 1)));
+}
+
+static VALUE rb_moments_skewness(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	if (m->n < 2)
+		return Qnil;
+	return DBL2NUM(sqrt((double) m->n) * m->m3 / pow(m->m2, 1.5));
+}
+
+/* excess kurtosis, zero for the Normal */
+static VALUE rb_moments_kurtosis(VALUE self)
+{
+	rv_moments_t *m;
+
+	GET_MOMENTS(self, m);
+	if (m->n < 2)
+		return Qnil;
+	return DBL2NUM(m->n * m->m4 / (m->m2 * m->m2) - 3.0);
+}
+
+/******************************************************************************/
+/* the moments of the samples, in a single pass */
+/******************************************************************************/
+static VALUE rb_samples_moments(VALUE self)
+{
+	rv_moments_t m;
+
+	rv_moments_init(&m);
+	moments_add_ary(&m, self);
+	return rv_moments_new(&m);
+}
+
+/******************************************************************************/
+/* the RandomVariable::TDigest class, a sketch of the quantiles of the samples
+   added so far */
+/******************************************************************************/
+#define TDIGEST_COMPRESSION	200.0
+
+static VALUE rb_cTDigest = Qnil;
+
+static VALUE rb_tdigest_alloc(VALUE klass)
+{
+	return Data_Wrap_Struct(klass, NULL, rv_tdigest_free, NULL);
+}
+
+#define GET_TDIGEST(rb_obj, t)						\
+	do {								\
+		if (!rb_obj_is_kind_of((rb_obj), rb_cTDigest))		\
+			rb_raise(rb_eTypeError, "not a "		\
+				"RandomVariable::TDigest object");	\
+		Data_Get_Struct((rb_obj), rv_tdigest_t, (t));		\
+		if (NULL == (t))					\
+			rb_raise(rb_eArgError, "uninitialized "		\
+				"RandomVariable::TDigest object");	\
+	} while (0)
+
+static void tdigest_set(VALUE rb_obj, double compression)
+{
+	rv_tdigest_t *t = rv_tdigest_alloc(compression);
+
+	if (NULL != DATA_PTR(rb_obj))
+		rv_tdigest_free(DATA_PTR(rb_obj));
+	DATA_PTR(rb_obj) = t;
+}
+
+static VALUE rb_tdigest_initialize(int argc, VALUE *argv, VALUE self)
+{
+	VALUE rb_compression;
+
+	rb_scan_args(argc, argv, "01", &rb_compression);
+	tdigest_set(self, NIL_P(rb_compression) ? 
+			TDIGEST_COMPRESSION : NUM2DBL(rb_compression));
+	return self;
+}
+
+/* it takes ownership of t */
+VALUE rv_tdigest_wrap(rv_tdigest_t *t)
+{
+	VALUE rb_tdigest = rb_tdigest_alloc(rb_cTDigest);
+
+	DATA_PTR(rb_tdigest) = t;
+	return rb_tdigest;
+}
+
+static VALUE rb_tdigest_initialize_copy(VALUE self, VALUE orig)
+{
+	rv_tdigest_t *src, *dst;
+
+	GET_TDIGEST(orig, src);
+	tdigest_set(self, src->compression);
+	Data_Get_Struct(self, rv_tdigest_t, dst);
+	rv_tdigest_copy(dst, src);
+	return self;
+}
+
+static VALUE rb_tdigest_add(VALUE self, VALUE rb_x)
+{
+	rv_tdigest_t *t;
+
+	GET_TDIGEST(self, t);
+	rv_tdigest_add(t, NUM2DBL(rb_x));
+	return self;
+}
+
+static void tdigest_add_ary(rv_tdigest_t *t, VALUE ary)
+{
+	double x[SAMPLES_BLOCK];
+	long n, b;
+
+	Check_Type(ary, T_ARRAY);
+	for (b = 0; (n = ary_block(ary, b, x)) > 0; b += n)
+		rv_tdigest_add_n(t, x, n);
+}
+
+static VALUE rb_tdigest_concat(VALUE self, VALUE ary)
+{
+	rv_tdigest_t *t;
+
+	GET_TDIGEST(self, t);
+	tdigest_add_ary(t, ary);
+	return self;
+}
+
+static VALUE rb_tdigest_merge_bang(VALUE self, VALUE other)
+{
+	rv_tdigest_t *a, *b;
+
+	GET_TDIGEST(self, a);
+	GET_TDIGEST(other, b);
+	if (a == b)
+		rb_raise(rb_eArgError, "a t-digest cannot be merged with "
+								"itself");
+	rv_tdigest_merge(a, b);
+	return self;
+}
+
+static VALUE rb_tdigest_merge(VALUE self, VALUE other)
+{
+	return rb_tdigest_merge_bang(rb_obj_dup(self), other);
+}
+
+static VALUE rb_tdigest_compression(VALUE self)
+{
+	rv_tdigest_t *t;
+
+	GET_TDIGEST(self, t);
+	return DBL2NUM(t->compression);
+}
+
+static VALUE rb_tdigest_count(VALUE self)
+{
+	rv_tdigest_t *t;
+
+	GET_TDIGEST(self, t);
+	return LONG2NUM((long) rv_tdigest_count(t));
+}
+
+/* nil while empty */
+static VALUE rb_tdigest_quantile(VALUE self, VALUE rb_q)
+{
+	rv_tdigest_t *t;
+	double q = NUM2DBL(rb_q);
+
+	GET_TDIGEST(self, t);
+	if (!(q >= 0.0 && q <= 1.0))
+		rb_raise(rb_eArgError, "the quantile must be between 0 and 1");
+	if (0.0 == rv_tdigest_count(t))
+		return Qnil;
+	return DBL2NUM(rv_tdigest_quantile(t, q));
+}
+
+/******************************************************************************/
+/* the RandomVariable::Histogram class, the counts of the samples added so far
+   in the bins of a fixed layout */
+/******************************************************************************/
+#define HISTOGRAM_LINEAR_BINS	100L
+#define HISTOGRAM_LOG_BINS	16L
+
+static VALUE rb_cHistogram = Qnil;
+
+static VALUE rb_histogram_alloc(VALUE klass)
+{
+	return Data_Wrap_Struct(klass, NULL, rv_histogram_free, NULL);
+}
+
+#define GET_HISTOGRAM(rb_obj, h)					\
+	do {								\
+		if (!rb_obj_is_kind_of((rb_obj), rb_cHistogram))	\
+			rb_raise(rb_eTypeError, "not a "		\
+				"RandomVariable::Histogram object");	\
+		Data_Get_Struct((rb_obj), rv_histogram_t, (h));		\
+		if (NULL == (h))					\
+			rb_raise(rb_eArgError, "uninitialized "		\
+				"RandomVariable::Histogram object");	\
+	} while (0)
+
+rv_histogram_t *rv_histogram_get(VALUE rb_histogram)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(rb_histogram, h);
+	return h;
+}
+
+static void histogram_set(VALUE rb_obj, rv_histogram_t *h)
+{
+	if (NULL != DATA_PTR(rb_obj))
+		rv_histogram_free(DATA_PTR(rb_obj));
+	DATA_PTR(rb_obj) = h;
+}
+
+/* the bins cover [range.begin, range.end) whether the range excludes its
+   end or not; when the scale is :log, bins is the number of bins every
+   power of two is split in, which has to be a power of two itself */
+static VALUE rb_histogram_initialize(int argc, VALUE *argv, VALUE self)
+{
+	VALUE rb_range, rb_bins, rb_scale, rb_lo, rb_hi;
+	ID scale;
+	long nr_bins;
+	int excl, bits;
+
+	rb_scan_args(argc, argv, "12", &rb_range, &rb_bins, &rb_scale);
+	if (!rb_range_values(rb_range, &rb_lo, &rb_hi, &excl) || 
+					NIL_P(rb_lo) || NIL_P(rb_hi))
+		rb_raise(rb_eArgError, "the range must have a beginning "
+							"and an end");
+	scale = NIL_P(rb_scale) ? rb_intern("linear") : SYM2ID(rb_scale);
+
+	if (rb_intern("linear") == scale) {
+		nr_bins = NIL_P(rb_bins) ? HISTOGRAM_LINEAR_BINS : 
+							NUM2LONG(rb_bins);
+		histogram_set(self, rv_histogram_alloc_linear(
+			NUM2DBL(rb_lo), NUM2DBL(rb_hi), nr_bins));
+	} else if (rb_intern("log") == scale) {
+		nr_bins = NIL_P(rb_bins) ? HISTOGRAM_LOG_BINS : 
+							NUM2LONG(rb_bins);
+		if (nr_bins < 1 || (nr_bins & (nr_bins - 1)))
+			rb_raise(rb_eArgError, "the bins per power of two "
+						"must be a power of two");
+		for (bits = 0; (1L << bits) < nr_bins; bits++)
+			;
+		histogram_set(self, rv_histogram_alloc_log(
+			NUM2DBL(rb_lo), NUM2DBL(rb_hi), bits));
+	} else {
+		rb_raise(rb_eArgError, "the scale must be :linear or :log");
+	}
+	return self;
+}
+
+static VALUE rb_histogram_initialize_copy(VALUE self, VALUE orig)
+{
+	rv_histogram_t *src, *dst;
+
+	GET_HISTOGRAM(orig, src);
+	dst = rv_histogram_alloc_like(src);
+	rv_histogram_merge(dst, src);
+	histogram_set(self, dst);
+	return self;
+}
+
+static VALUE rb_histogram_add(VALUE self, VALUE rb_x)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	rv_histogram_add(h, NUM2DBL(rb_x));
+	return self;
+}
+
+static VALUE rb_histogram_concat(VALUE self, VALUE ary)
+{
+	rv_histogram_t *h;
+	double x[SAMPLES_BLOCK];
+	long n, b;
+
+	GET_HISTOGRAM(self, h);
+	Check_Type(ary, T_ARRAY);
+	for (b = 0; (n = ary_block(ary, b, x)) > 0; b += n)
+		rv_histogram_add_n(h, x, n);
+	return self;
+}
+
+/* only histograms of the same layout are merged */
+static VALUE rb_histogram_merge_bang(VALUE self, VALUE other)
+{
+	rv_histogram_t *a, *b;
+
+	GET_HISTOGRAM(self, a);
+	GET_HISTOGRAM(other, b);
+	if (!rv_histogram_same_layout(a, b))
+		rb_raise(rb_eArgError, "the histograms do not have the same "
+								"bins");
+	rv_histogram_merge(a, b);
+	return self;
+}
+
+static VALUE rb_histogram_merge(VALUE self, VALUE other)
+{
+	return rb_histogram_merge_bang(rb_obj_dup(self), other);
+}
+
+static VALUE rb_histogram_counts(VALUE self)
+{
+	rv_histogram_t *h;
+	VALUE ary;
+	long i;
+
+	GET_HISTOGRAM(self, h);
+	ary = rb_ary_new2(h->nr_bins);
+	for (i = 1; i <= h->nr_bins; i++)
+		rb_ary_push(ary, LL2NUM(h->counts[i]));
+	return ary;
+}
+
+/* the nr_bins + 1 edges of the bins, the last one being excluded */
+static VALUE rb_histogram_edges(VALUE self)
+{
+	rv_histogram_t *h;
+	VALUE ary;
+	long i;
+
+	GET_HISTOGRAM(self, h);
+	ary = rb_ary_new2(h->nr_bins + 1);
+	for (i = 0; i <= h->nr_bins; i++)
+		rb_ary_push(ary, DBL2NUM(rv_histogram_edge(h, i)));
+	return ary;
+}
+
+static VALUE rb_histogram_underflow(VALUE self)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	return LL2NUM(h->counts[0]);
+}
+
+static VALUE rb_histogram_overflow(VALUE self)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	return LL2NUM(h->counts[h->nr_bins + 1]);
+}
+
+/* the samples added so far, those out of the range included */
+static VALUE rb_histogram_count(VALUE self)
+{
+	rv_histogram_t *h;
+	int64_t count = 0;
+	long i;
+
+	GET_HISTOGRAM(self, h);
+	for (i = 0; i < h->nr_bins + 2; i++)
+		count += h->counts[i];
+	return LL2NUM(count);
+}
+
+static VALUE rb_histogram_bins(VALUE self)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	return LONG2NUM(h->nr_bins);
+}
+
+static VALUE rb_histogram_range(VALUE self)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	return rb_range_new(DBL2NUM(h->lo), DBL2NUM(h->hi), 1);
+}
+
+static VALUE rb_histogram_scale(VALUE self)
+{
+	rv_histogram_t *h;
+
+	GET_HISTOGRAM(self, h);
+	return ID2SYM(rb_intern(rv_histogram_log == h->scale ? 
+							"log" : "linear"));
+}
+
+/******************************************************************************/
+/* a t-digest of the samples */
+/******************************************************************************/
+static VALUE rb_samples_digest(int argc, VALUE *argv, VALUE self)
+{
+	VALUE rb_tdigest = rb_class_new_instance(argc, argv, rb_cTDigest);
+	rv_tdigest_t *t;
+
+	GET_TDIGEST(rb_tdigest, t);
+	tdigest_add_ary(t, self);
+	return rb_tdigest;
+}
+
+void rv_init_samples(VALUE rb_mRandomVariable)
+{
+	VALUE rb_mSamples = rb_define_module_under(rb_mRandomVariable, 
+								"Samples");
+
+	rb_define_method(rb_mSamples, "max", rb_samples_max, 0);
+	rb_define_method(rb_mSamples, "min", rb_samples_min, 0);
+	rb_define_method(rb_mSamples, "mean", rb_samples_mean, 0);
+	rb_define_method(rb_mSamples, "median", rb_samples_median, 0);
+	rb_define_method(rb_mSamples, "moments", rb_samples_moments, 0);
+	rb_define_method(rb_mSamples, "digest", rb_samples_digest, -1);
+
+	rb_cMoments = rb_define_class_under(rb_mRandomVariable, "Moments",
+								rb_cObject);
+	rb_define_alloc_func(rb_cMoments, rb_moments_alloc);
+	rb_define_method(rb_cMoments, "initialize_copy", 
+					rb_moments_initialize_copy, 1);
+	rb_define_method(rb_cMoments, "add", rb_moments_add, 1);
+	rb_define_method(rb_cMoments, "<<", rb_moments_add, 1);
+	rb_define_method(rb_cMoments, "concat", rb_moments_concat, 1);
+	rb_define_method(rb_cMoments, "merge", rb_moments_merge, 1);
+	rb_define_method(rb_cMoments, "merge!", rb_moments_merge_bang, 1);
+	rb_define_method(rb_cMoments, "count", rb_moments_count, 0);
+	rb_define_method(rb_cMoments, "mean", rb_moments_mean, 0);
+	rb_define_method(rb_cMoments, "variance", rb_moments_variance, 0);
+	rb_define_method(rb_cMoments, "stddev", rb_moments_stddev, 0);
+	rb_define_method(rb_cMoments, "skewness", rb_moments_skewness, 0);
+	rb_define_method(rb_cMoments, "kurtosis", rb_moments_kurtosis, 0);
+
+	rb_cTDigest = rb_define_class_under(rb_mRandomVariable, "TDigest",
+								rb_cObject);
+	rb_define_alloc_func(rb_cTDigest, rb_tdigest_alloc);
+	rb_define_method(rb_cTDigest, "initialize", rb_tdigest_initialize, -1);
+	rb_define_method(rb_cTDigest, "initialize_copy", 
+					rb_tdigest_initialize_copy, 1);
+	rb_define_method(rb_cTDigest, "add", rb_tdigest_add, 1);
+	rb_define_method(rb_cTDigest, "<<", rb_tdigest_add, 1);
+	rb_define_method(rb_cTDigest, "concat", rb_tdigest_concat, 1);
+	rb_define_method(rb_cTDigest, "merge", rb_tdigest_merge, 1);
+	rb_define_method(rb_cTDigest, "merge!", rb_tdigest_merge_bang, 1);
+	rb_define_method(rb_cTDigest, "compression", 
+					rb_tdigest_compression, 0);
+	rb_define_method(rb_cTDigest, "count", rb_tdigest_count, 0);
+	rb_define_method(rb_cTDigest, "quantile", rb_tdigest_quantile, 1);
+
+	rb_cHistogram = rb_define_class_under(rb_mRandomVariable, "Histogram",
+								rb_cObject);
+	rb_define_alloc_func(rb_cHistogram, rb_histogram_alloc);
+	rb_define_method(rb_cHistogram, "initialize", 
+					rb_histogram_initialize, -1);
+	rb_define_method(rb_cHistogram, "initialize_copy", 
+					rb_histogram_initialize_copy, 1);
+	rb_define_method(rb_cHistogram, "add", rb_histogram_add, 1);
+	rb_define_method(rb_cHistogram, "<<", rb_histogram_add, 1);
+	rb_define_method(rb_cHistogram, "concat", rb_histogram_concat, 1);
+	rb_define_method(rb_cHistogram, "merge", rb_histogram_merge, 1);
+	rb_define_method(rb_cHistogram, "merge!", rb_histogram_merge_bang, 1);
+	rb_define_method(rb_cHistogram, "counts", rb_histogram_counts, 0);
+	rb_define_method(rb_cHistogram, "edges", rb_histogram_edges, 0);
+	rb_define_method(rb_cHistogram, "underflow", 
+					rb_histogram_underflow, 0);
+	rb_define_method(rb_cHistogram, "overflow", rb_histogram_overflow, 0);
+	rb_define_method(rb_cHistogram, "count", rb_histogram_count, 0);
+	rb_define_method(rb_cHistogram, "bins", rb_histogram_bins, 0);
+	rb_define_method(rb_cHistogram, "range", rb_histogram_range, 0);
+	rb_define_method(rb_cHistogram, "scale", rb_histogram_scale, 0);
+}
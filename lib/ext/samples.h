@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     samples.h                                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/02/16                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _SAMPLES_H_
+#define _SAMPLES_H_
+
+#include "tdigest.h"
+#include "histogram.h"
+
+/* the number of samples, their mean and the sums of the second to fourth
+   powers of their deviations from it */
+typedef struct {
+	long n;
+	double mean, m2, m3, m4;
+} rv_moments_t;
+
+extern void	rv_moments_init(rv_moments_t *);
+extern void	rv_moments_add(rv_moments_t *, double x);
+extern void	rv_moments_add_n(rv_moments_t *, const double *x, long n);
+extern void	rv_moments_merge(rv_moments_t *, const rv_moments_t *);
+/* a new RandomVariable::Moments object holding them */
+extern VALUE	rv_moments_new(const rv_moments_t *);
+
+/* a new RandomVariable::TDigest object, which takes ownership of t */
+extern VALUE	rv_tdigest_wrap(rv_tdigest_t *t);
+
+/* the histogram of a RandomVariable::Histogram object, TypeError if it is
+   not one */
+extern rv_histogram_t	*rv_histogram_get(VALUE rb_histogram);
+
+/* define the statistics of the RandomVariable::Samples module natively */
+extern void	rv_init_samples(VALUE rb_mRandomVariable);
+
+#endif /* _SAMPLES_H_ */
@@ -0,0 +1,61 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     tdigest.h                                                        //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/02/23                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _TDIGEST_H_
+#define _TDIGEST_H_
+
+#include <stddef.h>
+
+/* a cluster of samples, kept as their mean and their number */
+typedef struct {
+	double mean, weight;
+} rv_centroid_t;
+
+/* t-digest of the samples added so far: the centroids, sorted by mean, and
+   the samples not yet merged into them; its size is fixed by the
+   compression alone, whatever the number of samples */
+typedef struct {
+	double compression;
+	double total;		/* weight of the centroids */
+	double min, max;
+	long nr_centroids, max_centroids;
+	rv_centroid_t *centroids;
+	rv_centroid_t *scratch;	/* for merging, max_centroids + buffer_size */
+	long nr_buffered, buffer_size;
+	double *buffer;
+} rv_tdigest_t;
+
+/* it raises ArgumentError unless the compression is a valid one */
+extern void		rv_tdigest_check(double compression);
+extern rv_tdigest_t	*rv_tdigest_alloc(double compression);
+extern size_t		rv_tdigest_size(double compression);
+extern void		rv_tdigest_free(rv_tdigest_t *);
+extern void		rv_tdigest_reset(rv_tdigest_t *);
+/* NaN samples are ignored */
+extern void		rv_tdigest_add_n(rv_tdigest_t *, const double *x, 
+									long n);
+extern void		rv_tdigest_merge(rv_tdigest_t *, rv_tdigest_t *other);
+extern void		rv_tdigest_copy(rv_tdigest_t *dst, rv_tdigest_t *src);
+extern double		rv_tdigest_count(rv_tdigest_t *);
+/* NaN while empty */
+extern double		rv_tdigest_quantile(rv_tdigest_t *, double q);
+
+static inline void rv_tdigest_add(rv_tdigest_t *t, double x)
+{
+	rv_tdigest_add_n(t, &x, 1);
+}
+
+#endif /* _TDIGEST_H_ */
@@ -37,8 +37,10 @@
 #error "No math.h header found"
 #endif /* HAVE_MATH_H */
 
+#include "gen.h"
 #include "xrandlib.h"
 #include "randlib.h"
+#include "ziggurat.h"
 
 /* Arcsine */
 double gen_arcsine(void)
@@ -49,7 +51,7 @@ double gen_arcsine(void)
 /* Bates */
 double gen_bates(long n)
 {
-	return genirwinhall(n) / n;
+	return gen_irwin_hall(n) / n;
 }
 
 /* Bernoulli */
@@ -60,35 +62,102 @@ int gen_bernoulli(double p)
 	return 1;
 }
 
-/* Chi-Squared */
-double gen_chi_squared(long k)
+/* Discrete Uniform */
+
+/* uniform integer on [0, range), range = 0 standing for 2^64, by Lemire's
+   multiply-shift method: the rejection threshold is only computed in the
+   unlikely case it may be needed
+	Lemire, D. "Fast Random Integer Generation in an Interval."
+	ACM Transactions on Modeling and Computer Simulation, 29(1), 2019. */
+static inline uint64_t bounded(rv_gen_t *gen, uint64_t range)
 {
-	return genchi((double) k);
+	uint64_t x = rv_gen_next(gen);
+#ifdef __SIZEOF_INT128__
+	__uint128_t m;
+	uint64_t l, t;
+
+	if (0 == range)
+		return x;
+	m = (__uint128_t) x * range;
+	l = (uint64_t) m;
+	if (l < range) {
+		t = -range % range;
+		while (l < t) {
+			x = rv_gen_next(gen);
+			m = (__uint128_t) x * range;
+			l = (uint64_t) m;
+		}
+	}
+	return (uint64_t) (m >> 64);
+#else
+	uint64_t t;
+
+	if (0 == range)
+		return x;
+	t = -range % range;
+	while (x < t)
+		x = rv_gen_next(gen);
+	return x % range;
+#endif
 }
 
-/* Discrete Uniform */
 long gen_discrete_uniform(long a, long b)
 {
 	/* assumptions:
 		1) a != b
 		2) a < b
 	*/
-	double step;
-	long step_nr;
-	double y, y0;
+	uint64_t range = (uint64_t) b - (uint64_t) a + 1;
+
+	return (long) ((uint64_t) a + bounded(rv_gen_current(), range));
+}
+
+/* several Discrete Uniform outcomes at once */
+void gen_discrete_uniform_fill(long a, long b, long *outcomes, long nr)
+{
+	uint64_t range = (uint64_t) b - (uint64_t) a + 1;
+	rv_gen_t *gen = rv_gen_current();
+	long i;
+
+	for (i = 0; i < nr; i++)
+		outcomes[i] = (long) ((uint64_t) a + bounded(gen, range));
+}
 
-	step = 1.0 / (b - a + 1);
-	y = step;
-	y0 = ranf();
-	step_nr = 0;
+/* Gamma */
 
-	do {
-		if (y0 <= y)
+/* Marsaglia, G. and Tsang, W.W. "A Simple Method for Generating Gamma
+   Variables." ACM Transactions on Mathematical Software, 26(3), 2000.
+   A shape a below one is boosted to a + 1, as G(a) = G(a + 1) U^(1/a) */
+void gen_gamma_setup(gen_gamma_t *st, double shape)
+{
+	st->shape = shape;
+	st->inv_shape = (shape < 1.0) ? 1.0 / shape : 0.0;
+	st->d = ((shape < 1.0) ? shape + 1.0 : shape) - 1.0 / 3.0;
+	st->c = 1.0 / sqrt(9.0 * st->d);
+}
+
+double gen_gamma(const gen_gamma_t *st)
+{
+	rv_gen_t *gen = rv_gen_current();
+	double x, v, u;
+
+	for (;;) {
+		do {
+			x = zig_norm();
+			v = 1.0 + st->c * x;
+		} while (v <= 0.0);
+		v = v * v * v;
+		u = rv_gen_ranf(gen);
+
+		/* the squeeze accepts most of them */
+		if (u < 1.0 - 0.0331 * (x * x) * (x * x))
+			break;
+		if (log(u) < 0.5 * x * x + st->d * (1.0 - v + log(v)))
 			break;
-		y += step;
-		++step_nr;	
-	} while (1);
-	return a + step_nr;	
+	}
+	if (0.0 != st->inv_shape)
+		return st->d * v * pow(rv_gen_ranf(gen), st->inv_shape);
+	return st->d * v;
 }
 
 /* Irwin-Hall */
@@ -101,6 +170,139 @@ double gen_irwin_hall(long n)
 	return sum;	
 }
 
+/* Multivariate Normal */
+
+/* parm is laid out as setgmn lays it out, p followed by the mean and the
+   Cholesky factor, but the factor is kept as the rows of the lower triangular
+   L = trans(A) one after the other, row i being made of i + 1 contiguous
+   elements; cov, given by columns, is destroyed.  It returns the order of the
+   leading minor of cov not positive definite, zero on success */
+long gen_multivariate_normal_setup(double *parm, const double *mean,
+					double *cov, long p)
+{
+	extern void spofa(double *a, long lda, long n, long *info);
+	double *l;
+	long info, i, j;
+
+	spofa(cov, p, p, &info);
+	if (0 != info)
+		return info;
+
+	parm[0] = (double) p;
+	for (i = 0; i < p; i++)
+		parm[1 + i] = mean[i];
+
+	/* spofa leaves A in the upper triangle, its column i being row i
+	   of L */
+	l = parm + 1 + p;
+	for (i = 0; i < p; i++)
+		for (j = 0; j <= i; j++)
+			*l++ = cov[j + i * p];
+	return 0;
+}
+
+static inline double dot(const double *a, const double *b, long n)
+{
+	double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+	long i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		s0 += a[i] * b[i];
+		s1 += a[i + 1] * b[i + 1];
+		s2 += a[i + 2] * b[i + 2];
+		s3 += a[i + 3] * b[i + 3];
+	}
+	for (; i < n; i++)
+		s0 += a[i] * b[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+/* nr deviates into x, one after the other: a block of them is filled with
+   standard normal deviates e, then x = L e + mean is worked out in place from
+   the last element up, as x[i] depends on e[0..i] alone.  Every row of L is
+   thus loaded once per block rather than once per deviate */
+#define MVN_BLOCK	32L
+
+void gen_multivariate_normal_fill(const double *parm, double *x, long nr)
+{
+	long p = (long) parm[0];
+	const double *mean = parm + 1, *row;
+	double *block, *e;
+	long b, n, i, k;
+
+	for (b = 0; b < nr; b += MVN_BLOCK) {
+		n = (nr - b < MVN_BLOCK) ? nr - b : MVN_BLOCK;
+		block = x + b * p;
+		for (i = 0; i < n * p; i++)
+			block[i] = rv_snorm();
+		for (i = p - 1; i >= 0; i--) {
+			row = mean + p + i * (i + 1) / 2;
+			for (k = 0, e = block; k < n; k++, e += p)
+				e[i] = dot(row, e, i + 1) + mean[i];
+		}
+	}
+}
+
+/* Poisson */
+
+/* PTRS, transformed rejection with squeeze, for mu >= 10
+	Hormann, W. "The Transformed Rejection Method for Generating
+	Poisson Random Variables." Insurance: Mathematics and Economics,
+	12(1), 1993. */
+void gen_poisson_ptrs_setup(gen_poisson_ptrs_t *st, double mu)
+{
+	double smu = sqrt(mu);
+
+	st->mu = mu;
+	st->log_mu = log(mu);
+	st->b = 0.931 + 2.53 * smu;
+	st->a = -0.059 + 0.02483 * st->b;
+	st->inv_alpha = 1.1239 + 1.1328 / (st->b - 3.4);
+	st->log_inv_alpha = log(st->inv_alpha);
+	st->vr = 0.9277 - 3.6224 / (st->b - 2);
+}
+
+/* log(k!), by Stirling's series from k = 10 on: lgamma() is not reentrant
+   as it sets signgam */
+static double log_factorial(double k)
+{
+	static const double table[10] = {
+		0.0, 0.0, 0.69314718055994531, 1.79175946922805500,
+		3.17805383034794562, 4.78749174278204599,
+		6.57925121201010100, 8.52516136106541430,
+		10.60460290274525023, 12.80182748008146961
+	};
+	double k2;
+
+	if (k < 10)
+		return table[(int) k];
+	k2 = k * k;
+	return (k + 0.5) * log(k) - k + 0.91893853320467274 +
+		(1.0 / 12 - (1.0 / 360 - 1.0 / (1260 * k2)) / k2) / k;
+}
+
+long gen_poisson_ptrs(const gen_poisson_ptrs_t *st)
+{
+	rv_gen_t *gen = rv_gen_current();
+	double u, v, us, k;
+
+	for (;;) {
+		u = rv_gen_ranf(gen) - 0.5;
+		v = rv_gen_ranf(gen);
+		us = 0.5 - fabs(u);
+		k = floor((2 * st->a / us + st->b) * u + st->mu + 0.43);
+
+		/* the squeeze accepts most of them */
+		if (us >= 0.07 && v <= st->vr)
+			return (long) k;
+		if (k < 0 || (us < 0.013 && v > us))
+			continue;
+		if (log(v) + st->log_inv_alpha - log(st->a / (us * us) + st->b)
+			<= -st->mu + k * st->log_mu - log_factorial(k))
+			return (long) k;
+	}
+}
+
 /* Rademacher */
 int gen_rademacher(void)
 {
@@ -18,10 +18,33 @@
 #define _XRANDLIB_H_
 
 extern int 	gen_bernoulli(double);
-extern double 	gen_chi_squared(long);
 extern long	gen_discrete_uniform(long a, long b);
+extern void	gen_discrete_uniform_fill(long a, long b, long *, long);
 extern double 	gen_exponential(double);
+
+/* standard Gamma by Marsaglia and Tsang's method, set up once per shape */
+typedef struct {
+	double shape, d, c;
+	double inv_shape;	/* for shapes below one, zero otherwise */
+} gen_gamma_t;
+extern void	gen_gamma_setup(gen_gamma_t *, double shape);
+extern double	gen_gamma(const gen_gamma_t *);
+extern double	gen_irwin_hall(long n);
+
+/* Multivariate Normal, out of parm set up once by means of a Cholesky
+   factorization of the covariance */
+extern long	gen_multivariate_normal_setup(double *parm, const double *mean,
+						double *cov, long p);
+extern void	gen_multivariate_normal_fill(const double *parm, double *x,
+						long nr);
+
 extern double	gen_pareto(double, double);
+/* Poisson by transformed rejection, set up once per mean */
+typedef struct {
+	double mu, log_mu, b, a, inv_alpha, log_inv_alpha, vr;
+} gen_poisson_ptrs_t;
+extern void	gen_poisson_ptrs_setup(gen_poisson_ptrs_t *, double mu);
+extern long	gen_poisson_ptrs(const gen_poisson_ptrs_t *);
 extern int 	gen_rademacher(void);
 extern double 	gen_rayleigh(double);
 extern double	gen_rectangular(void);
@@ -0,0 +1,184 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     ziggurat.c                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/01/19                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+/*******************************************************************************
+    random_variable gem for the creation or random variables in Ruby
+    Copyright (C) 2012 Jorge Fco. Madronal Rinaldi
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+/*******************************************************************************
+    Ziggurat method for the standard normal and exponential distributions
+
+    Marsaglia, G. and Tsang, W.W. "The Ziggurat Method for Generating
+    Random Variables." Journal of Statistical Software, 5(8), 2000.
+
+    The tables are those of the paper (128 layers for the normal, 256 for
+    the exponential), scaled for taking the integer part from the top 53
+    bits of a 64-bit generator output and the layer from its lowest bits.
+*******************************************************************************/
+
+#ifdef HAVE_MATH_H
+#include <math.h>
+#else
+#error "No math.h header found"
+#endif /* HAVE_MATH_H */
+
+#include "gen.h"
+#include "randlib.h"
+#include "ziggurat.h"
+
+#define ZIG_NORM_LAYERS		128
+#define ZIG_NORM_R		3.442619855899
+#define ZIG_NORM_V		9.91256303526217e-3
+#define ZIG_EXP_LAYERS		256
+#define ZIG_EXP_R		7.697117470131487
+#define ZIG_EXP_V		3.949659822581572e-3
+
+/* 2^52 and 2^53 */
+#define ZIG_M52			4503599627370496.0
+#define ZIG_M53			9007199254740992.0
+
+static uint64_t kn[ZIG_NORM_LAYERS], ke[ZIG_EXP_LAYERS];
+static double wn[ZIG_NORM_LAYERS], fn[ZIG_NORM_LAYERS];
+static double we[ZIG_EXP_LAYERS], fe[ZIG_EXP_LAYERS];
+
+/* Must be called BEFORE any zig_norm() or zig_exp() call !! */
+void rv_init_ziggurat(void)
+{
+	double dn = ZIG_NORM_R, tn = dn, vn = ZIG_NORM_V, q;
+	double de = ZIG_EXP_R, te = de, ve = ZIG_EXP_V;
+	int i;
+
+	/* normal */
+	q = vn / exp(-0.5 * dn * dn);
+	kn[0] = (uint64_t) ((dn / q) * ZIG_M52);
+	kn[1] = 0;
+	wn[0] = q / ZIG_M52;
+	wn[ZIG_NORM_LAYERS - 1] = dn / ZIG_M52;
+	fn[0] = 1.0;
+	fn[ZIG_NORM_LAYERS - 1] = exp(-0.5 * dn * dn);
+	for (i = ZIG_NORM_LAYERS - 2; i >= 1; i--) {
+		dn = sqrt(-2.0 * log(vn / dn + exp(-0.5 * dn * dn)));
+		kn[i + 1] = (uint64_t) ((dn / tn) * ZIG_M52);
+		tn = dn;
+		fn[i] = exp(-0.5 * dn * dn);
+		wn[i] = dn / ZIG_M52;
+	}
+
+	/* exponential */
+	q = ve / exp(-de);
+	ke[0] = (uint64_t) ((de / q) * ZIG_M53);
+	ke[1] = 0;
+	we[0] = q / ZIG_M53;
+	we[ZIG_EXP_LAYERS - 1] = de / ZIG_M53;
+	fe[0] = 1.0;
+	fe[ZIG_EXP_LAYERS - 1] = exp(-de);
+	for (i = ZIG_EXP_LAYERS - 2; i >= 1; i--) {
+		de = -log(ve / de + exp(-de));
+		ke[i + 1] = (uint64_t) ((de / te) * ZIG_M53);
+		te = de;
+		fe[i] = exp(-de);
+		we[i] = de / ZIG_M53;
+	}
+}
+
+/* standard normal */
+double zig_norm(void)
+{
+	uint64_t u, abs_j;
+	int64_t j;
+	double x, y;
+	int i;
+
+	for (;;) {
+		u = ranu64();
+		i = (int) (u & (ZIG_NORM_LAYERS - 1));
+		/* signed 53-bit integer from the top bits */
+		j = (int64_t) (u >> 11) - ((int64_t) 1 << 52);
+		abs_j = (uint64_t) (j < 0 ? -j : j);
+		x = j * wn[i];
+
+		/* inside the rectangle, most of the time */
+		if (abs_j < kn[i])
+			return x;
+
+		/* the tail */
+		if (0 == i) {
+			do {
+				x = -log(ranf()) / ZIG_NORM_R;
+				y = -log(ranf());
+			} while (y + y < x * x);
+			return (j > 0) ? ZIG_NORM_R + x : -ZIG_NORM_R - x;
+		}
+
+		/* the wedge */
+		if (fn[i] + ranf() * (fn[i - 1] - fn[i]) < exp(-0.5 * x * x))
+			return x;
+	}
+}
+
+/* standard exponential */
+double zig_exp(void)
+{
+	uint64_t u, j;
+	double x;
+	int i;
+
+	for (;;) {
+		u = ranu64();
+		i = (int) (u & (ZIG_EXP_LAYERS - 1));
+		j = u >> 11;
+		x = j * we[i];
+
+		/* inside the rectangle, most of the time */
+		if (j < ke[i])
+			return x;
+
+		/* the tail */
+		if (0 == i)
+			return ZIG_EXP_R - log(ranf());
+
+		/* the wedge */
+		if (fe[i] + ranf() * (fe[i - 1] - fe[i]) < exp(-x))
+			return x;
+	}
+}
+
+double rv_snorm(void)
+{
+	if (rv_algorithm_classic == rv_algorithm)
+		return snorm();
+	return zig_norm();
+}
+
+double rv_sexpo(void)
+{
+	if (rv_algorithm_classic == rv_algorithm)
+		return sexpo();
+	return zig_exp();
+}
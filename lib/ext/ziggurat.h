@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// File:     ziggurat.h                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Author:   Jorge F.M. Rinaldi                                               //
+// Contact:  jorge.madronal.rinaldi@gmail.com                                 //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+//                                                                            //
+// Date:     2013/01/19                                                       //
+//                                                                            //
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef _ZIGGURAT_H_
+#define _ZIGGURAT_H_
+
+extern void	rv_init_ziggurat(void);
+extern double	zig_norm(void);
+extern double	zig_exp(void);
+
+/* standard normal and exponential deviates by means of the algorithm
+   currently selected (see rv_algorithm) */
+extern double	rv_snorm(void);
+extern double	rv_sexpo(void);
+
+#endif /* _ZIGGURAT_H_ */
@@ -64,7 +64,8 @@ module RandomVariable
 		distros = []
 		self.constants.each do |c|
 			c = self.const_get(c)
-			if c.is_a? Class and c != self::Generic then
+			if c.is_a? Class and c < self::Generic and
+				c != self::Expression then
 				distros << c
 			end
 		end
@@ -81,15 +82,18 @@ module RandomVariable
 			
 			class << self
 				def outcome
-					@blk.call
+					Generic.joint_draw { @blk.call }
 				end
 				alias :sample :outcome
 
-				def outcomes(nr_samples)
-					ary = []
-					nr_samples.times do
-						ary << @blk.call
+				def outcomes(nr_samples, into: nil)
+					ary = into || Array.new(nr_samples)
+					nr_samples.times do |i|
+						ary[i] = Generic.joint_draw do
+							@blk.call
+						end
 					end
+					ary.slice!(nr_samples..-1)
 					class << ary
 						include RandomVariable::Samples
 					end
@@ -99,17 +103,60 @@ module RandomVariable
 			end
 		end
 
+		# the outcomes drawn so far by the joint draw going on in this
+		# thread, by random variable
+		JOINT_DRAW = :random_variable_joint_draw
+		private_constant :JOINT_DRAW
+
+		# yield within a joint draw, in which every random variable
+		# combined by the operators below takes a single outcome
+		# however many times it appears
+		def self.joint_draw
+			return yield unless Thread.current[JOINT_DRAW].nil?
+			Thread.current[JOINT_DRAW] = {}.compare_by_identity
+			begin
+				yield
+			ensure
+				Thread.current[JOINT_DRAW] = nil
+			end
+		end
+
+		# the outcome of +rv+ in the joint draw going on; that of an
+		# Expression is worked out of the outcomes its random
+		# variables take in the draw as well
+		def self.joint_outcome(rv)
+			draw = Thread.current[JOINT_DRAW]
+			return rv.outcome if draw.nil?
+			draw.fetch(rv) do
+				draw[rv] = rv.is_a?(Expression) ?
+					rv.send(:intern_joint_outcome) :
+					rv.outcome
+			end
+		end
+
 		operators = %w(+ - * / % **)
 
+		# random variables of this library and Integer or Float numbers
+		# are combined into a RandomVariable::Expression, which is
+		# evaluated natively; anything else by means of a block, and
+		# so is ** on two Integer operands.  Beware that an Integer
+		# outcome of an Expression too big for 64 bits raises
+		# RangeError instead of growing into a Bignum as Ruby's do
 		operators.each do |op|
 			define_method(op) do |arg|
+				expr = Expression.send(:intern_new, op.to_sym,
+								self, arg)
+				return expr unless expr.nil?
 				if arg.is_a? klass then
 					return klass.new {
-						self.outcome.send(op,
-								arg.outcome) 
-						}
+						x = klass.joint_outcome(self)
+						y = klass.joint_outcome(arg)
+						x.send(op, y)
+					}
 				end
-				klass.new { self.outcome.send(op, arg) }
+				klass.new {
+					klass.joint_outcome(self).send(op, arg)
+				}
 			end
 		end
 
@@ -118,28 +165,30 @@ end
 
 require_relative 'distros.rb'
 
-=begin
-module Math
-
+module RandomVariable
 	functions = [:acos, :acosh, :asin, :asinh, :atan, :atanh, :cbrt,
-			 :cos, :cosh, :erf, :erfc, :exp, :frexp, :gamma,
-			 :lgamma, :log, :log10, :log2, :sin, :sinh, :sqrt,
-			 :tan, :tanh]
-	klass = RandomVariable
-
+			 :cos, :cosh, :erf, :erfc, :exp, :gamma, :log, :log10,
+			 :log2, :sin, :sinh, :sqrt, :tan, :tanh]
+
+	# the functions of the Math module lifted to random variables, e.g.
+	# RandomVariable.exp(Normal.new) is a log-normal random variable;
+	# those of this library are transformed natively, yielding NaN
+	# outcomes where Math would raise Math::DomainError, while numbers
+	# are just passed to Math
 	functions.each do |method_name|
-		original_method = self.method method_name
-
 		define_singleton_method(method_name) do |arg|
-			unless arg.is_a? klass then
-				return original_method.call arg
+			expr = Expression.send(:intern_new, method_name,
+							arg, nil)
+			return expr unless expr.nil?
+			unless arg.is_a? Generic then
+				return Math.send(method_name, arg)
 			end
-
-			return klass.new { original_method.call(arg.outcome) }
+			Generic.new {
+				x = Generic.joint_outcome(arg)
+				Math.send(method_name, x)
+			}
 		end
 	end
-
 end
-=end
 
 
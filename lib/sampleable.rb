@@ -21,12 +21,179 @@ module RandomVariable::Sampleable
 	end
 	alias :sample :outcome
 
-	def outcomes(nr_samples)
-		samples_ary = intern_outcomes(nr_samples)
+	SUM_CHUNK = 1 << 20
+	private_constant :SUM_CHUNK
+
+	# obtain the sum of +nr_samples+ outcomes, drawn at once out of
+	# its own distribution wherever it is known (a Binomial for the
+	# Bernoulli, a Gamma for the Exponential, a Normal for the
+	# Normal...) and otherwise out of the outcomes themselves
+	#
+	# @param [Integer] nr_samples number of outcomes
+	# @return [Numeric, Array] the sum, an Array for vector outcomes
+	def sum_of(nr_samples)
+		if respond_to?(:intern_sum_of, true)
+			sum = intern_sum_of(nr_samples)
+			return sum unless sum.nil?
+		end
+		if nr_samples < 0
+			raise ArgumentError, "the number of outcomes cannot " \
+							"be negative"
+		end
+		sum = 0
+		while nr_samples > 0
+			nr = [nr_samples, SUM_CHUNK].min
+			sum += outcomes(nr).sum
+			nr_samples -= nr
+		end
+		sum
+	end
+
+	# obtain the mean of +nr_samples+ outcomes, as +sum_of+ does
+	#
+	# @param [Integer] nr_samples number of outcomes, at least one
+	# @return [Float, Array] the mean, an Array for vector outcomes
+	def mean_of(nr_samples)
+		raise ArgumentError, "there must be at least one outcome" \
+			if nr_samples < 1
+		sum = sum_of(nr_samples)
+		return sum.map { |x| x.fdiv(nr_samples) } if sum.is_a? Array
+		sum.fdiv(nr_samples)
+	end
+
+	# obtain +nr_samples+ outcomes
+	#
+	# @param [Integer] nr_samples number of outcomes
+	# @param [Array] into array whose elements are replaced by the
+	#	outcomes instead of creating a new array
+	# @return [Array] the outcomes
+	def outcomes(nr_samples, into: nil)
+		samples_ary = intern_outcomes(nr_samples, into)
 		class << samples_ary
 			include RandomVariable::Samples
 		end
 		samples_ary
 	end
 	alias :samples :outcomes
+
+	# replace every element of +ary+ by a new outcome
+	#
+	# @param [Array] ary
+	# @return [Array] +ary+
+	def fill(ary)
+		outcomes(ary.size, into: ary)
+	end
+
+	# obtain +nr_samples+ outcomes packed into a binary String as
+	# little-endian doubles or 64-bit integers (see +packed_type+),
+	# no Ruby object is created per outcome
+	#
+	# @param [Integer] nr_samples number of outcomes
+	# @param [String, IO::Buffer] buffer where to write the outcomes
+	#	instead of a new String, a String is resized as needed
+	# @return [String, IO::Buffer] the buffer holding the outcomes
+	def outcomes_packed(nr_samples, buffer = nil)
+		intern_outcomes_packed(nr_samples, buffer)
+	end
+	alias :samples_packed :outcomes_packed
+
+	SUMMARY_STATS = [:count, :mean, :var, :stddev, :skewness, :kurtosis,
+					:min, :max, :quantiles, :digest]
+
+	# draw +nr_samples+ outcomes and fold them into the statistics
+	# +stats+ as they are drawn, a chunk at a time, so that memory use
+	# does not grow with +nr_samples+; native random variables do it
+	# within the sampling loop, split among the native threads
+	#
+	# @param [Integer] nr_samples number of outcomes
+	# @param [Array] stats some of :count, :mean, :var, :stddev,
+	#	:skewness, :kurtosis, :min, :max, :quantiles and :digest
+	# @param [Array] quantiles the ones given by :quantiles, out of a
+	#	RandomVariable::TDigest, which :digest gives itself
+	# @param [Numeric] compression that of the t-digest
+	# @return [Hash] the value of each statistic, by name
+	def summarize(nr_samples, stats: [:mean, :var, :min, :max],
+			quantiles: [0.5, 0.95, 0.99, 0.999], compression: 200)
+		unknown = stats - SUMMARY_STATS
+		raise ArgumentError, "unknown statistics: " \
+			"#{unknown.join(', ')}" unless unknown.empty?
+		compression = nil if (stats & [:quantiles, :digest]).empty?
+		summary = intern_summarize(nr_samples, compression, nil) \
+			if respond_to?(:intern_summarize, true)
+		moments, min, max, digest = summary ||
+			summarize_outcomes(nr_samples, compression)
+		stats.each_with_object({}) do |stat, values|
+			values[stat] = case stat
+				when :min then min
+				when :max then max
+				when :var then moments.variance
+				when :digest then digest
+				when :quantiles then digest.quantiles(quantiles)
+				else moments.send(stat)
+				end
+		end
+	end
+
+	# count +nr_samples+ outcomes into the bins of a histogram as they
+	# are drawn, the way +summarize+ does, so that neither the outcomes
+	# nor more than a chunk of them are ever kept
+	#
+	# @param [Integer] nr_samples number of outcomes
+	# @param [Range] range the one covered by the bins, its end excluded
+	# @param [Integer] bins their number, or when +scale+ is :log the
+	#	number of them every power of two is split in
+	# @param [Symbol] scale :linear, for bins of the same width, or :log
+	#	for bins of the same relative width over a positive +range+
+	# @param [RandomVariable::Histogram] into where to count the outcomes
+	#	instead of a new histogram, adding to its counts
+	# @return [RandomVariable::Histogram] the histogram
+	def histogram(nr_samples, range: nil, bins: nil, scale: :linear,
+								into: nil)
+		into ||= RandomVariable::Histogram.new(range, bins, scale)
+		summary = intern_summarize(nr_samples, nil, into) \
+			if respond_to?(:intern_summarize, true)
+		summarize_outcomes(nr_samples, nil, into) if summary.nil?
+		into
+	end
+
+	# [moments, min, max, t-digest] of +nr_samples+ outcomes, drawn a
+	# chunk at a time, the t-digest being nil without a +compression+;
+	# they are also counted into +histogram+ unless it is nil
+	def summarize_outcomes(nr_samples, compression, histogram = nil)
+		if nr_samples < 0
+			raise ArgumentError, "the number of outcomes cannot " \
+							"be negative"
+		end
+		moments = RandomVariable::Moments.new
+		digest = RandomVariable::TDigest.new(compression) \
+			unless compression.nil?
+		min = max = chunk = nil
+		while nr_samples > 0
+			nr = [nr_samples, SUM_CHUNK].min
+			chunk = outcomes(nr, into: chunk)
+			moments.concat(chunk)
+			digest.concat(chunk) unless digest.nil?
+			histogram.concat(chunk) unless histogram.nil?
+			lo, hi = chunk.min, chunk.max
+			min = lo if min.nil? or lo < min
+			max = hi if max.nil? or hi > max
+			nr_samples -= nr
+		end
+		[moments, min, max, digest]
+	end
+	private :summarize_outcomes
+
+	# make the outcomes be drawn from +generator+ instead of the
+	# default generator, nothing is changed if +generator+ is +nil+.
+	# An Expression or a Mixture draws all of its outcomes from a
+	# single generator, that of the first of its random variables
+	# bound to one; it raises ArgumentError on random variables bound
+	# to different generators
+	#
+	# @param [RandomVariable::Generator] generator
+	# @return self
+	def with_generator(generator)
+		self.generator = generator unless generator.nil?
+		self
+	end
 end
@@ -21,41 +21,64 @@ module RandomVariable::Samples
 			end	
 		end
 	end
-	
-	def max
-		cur_max = self[0]
-		self.iterate_samples do |sample|
-			cur_max = sample if sample > cur_max
-		end
-		cur_max
+
+	# max, min, mean, median, moments and digest are defined by the
+	# native extension
+
+	# the histogram of the samples (see RandomVariable::Histogram.new)
+	def histogram(range:, bins: nil, scale: :linear)
+		RandomVariable::Histogram.new(range, bins, scale).concat(self)
 	end
-	
-	def min
-		cur_min = self[0]
-		self.iterate_samples do |sample|
-			cur_min = sample if sample < cur_min
-		end
-		cur_min
+
+	# the unbiased variance, the standard deviation, the skewness and
+	# the excess kurtosis of the samples, all of them out of a single
+	# pass over the samples (see +moments+)
+	%w(variance stddev skewness kurtosis).each do |stat|
+		define_method(stat) { moments.send(stat) }
 	end
+end
 
-	def mean
-		return nil if 0 == self.size
-		acc = 0.0
-		self.iterate_samples do |sample|
-			acc += sample
-		end
-		acc / self.size
-	end
-
-	def median
-		return nil if 0 == self.size
-		return self[0] if 1 == self.size
-		ary = self.sort
-		i = ary.len / 2
-		if ary.len.even? then
-			return (ary[i] + ary[i-1]) / 2.0
-		else
-			return ary[i]
-		end
+# the moments of the samples added so far, mergeable with those of
+# other samples (see RandomVariable::Samples#moments)
+class RandomVariable::Moments
+	def to_h
+		{ count: count, mean: mean, variance: variance,
+			skewness: skewness, kurtosis: kurtosis }
+	end
+
+	def inspect
+		"#<#{self.class} #{to_h}>"
+	end
+end
+
+# a t-digest of the samples added so far, a sketch of bounded size from
+# which their quantiles are approximated, the extreme ones the most
+# accurately; the t-digests of separate samples can be merged (see
+# RandomVariable::Samples#digest)
+class RandomVariable::TDigest
+	# the value of each of the +qs+ quantiles, by quantile
+	def quantiles(qs = [0.5, 0.95, 0.99, 0.999])
+		qs.each_with_object({}) { |q, values| values[q] = quantile(q) }
+	end
+
+	def inspect
+		"#<#{self.class} count=#{count} #{quantiles}>"
+	end
+end
+
+# the counts of the samples added so far in bins of a fixed layout, either
+# of the same width or, as in an HDR histogram, of the same relative width;
+# the samples out of the range are counted apart, and the histograms of
+# separate samples can be merged if their bins are the same (see
+# RandomVariable::Samples#histogram)
+class RandomVariable::Histogram
+	# [lower edge, upper edge, count] of each bin
+	def to_a
+		edges.each_cons(2).zip(counts).map { |(lo, hi), n| [lo, hi, n] }
+	end
+
+	def inspect
+		"#<#{self.class} #{scale} #{range} bins=#{bins} " \
+		"count=#{count} underflow=#{underflow} overflow=#{overflow}>"
 	end
 end
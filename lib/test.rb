@@ -17,4 +17,11 @@ require 'random_variable'
 
 require_relative 'tests/environment.rb'
 require_relative 'tests/bernoulli.rb'
+require_relative 'tests/categorical.rb'
+require_relative 'tests/expression.rb'
+require_relative 'tests/gamma.rb'
+require_relative 'tests/generator.rb'
+require_relative 'tests/mixture.rb'
+require_relative 'tests/multivariate_normal.rb'
 require_relative 'tests/poisson.rb'
+require_relative 'tests/samples.rb'
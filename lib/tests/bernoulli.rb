@@ -90,4 +90,48 @@ class RandomVariable::Tests::Bernoulli < RandomVariable::Tests::TestCase
 		end	
 	end	
 
+	should "succeed with probability p however outcomes are produced" do
+		valid_params.each do |param|
+			x = Bernoulli.new param
+			delta = 5 * Math.sqrt(param * (1 - param) / 100_000) + 
+									1e-5
+			assert_in_delta(param, x.outcomes(100_000).sum / 
+						100_000.0, delta)
+			assert_in_delta(param, x.count_successes(100_000) / 
+						100_000.0, delta)
+			bits = x.outcomes_bits(100_000)
+			assert_equal(12_500, bits.bytesize)
+			assert_in_delta(param, bits.unpack1("b*").count("1") / 
+						100_000.0, delta)
+		end
+	end
+
+	should "pack its outcomes into as few bytes as needed" do
+		x = Rademacher.new
+		assert_equal("", x.outcomes_bits(0))
+		assert_equal(0, x.count_successes(0))
+		bits = x.outcomes_bits(67)
+		assert_equal(9, bits.bytesize)
+		assert_equal(0, bits.getbyte(8) >> 3)
+		assert(x.outcomes(1000).all? { |sample| sample.abs == 1 })
+	end
+
+	should "sum many outcomes at once with the right moments" do
+		[[Bernoulli.new(0.3), 0.3, 0.21], [Rademacher.new, 0.0, 1.0],
+		 [Exponential.new(2.0), 2.0, 4.0], 
+		 [Normal.new(-1.0, 3.0), -1.0, 9.0]].each do |x, mu, var|
+			sums = Array.new(20_000) { x.sum_of(1000) }
+			mean = sums.sum / 20_000.0
+			assert_in_delta(1000 * mu, mean, 
+					5 * Math.sqrt(var / 20.0))
+			assert_in_delta(1.0, sums.sum { |s| (s - mean)**2 } / 
+					19_999.0 / (1000 * var), 0.05)
+		end
+		assert_equal(0, Bernoulli.new(0.5).sum_of(0))
+		assert_in_delta(2.0, Exponential.new(2.0).mean_of(10**9), 1e-3)
+		x = Generic.new { 2 }
+		assert_equal(6, x.sum_of(3))
+		assert_equal(2.0, x.mean_of(3))
+		assert_raise(ArgumentError) { x.mean_of(0) }
+	end
 end
@@ -0,0 +1,52 @@
+################################################################################
+#                                                                              #
+# File:     categorical.rb                                                     #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/01/26                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::Categorical < RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	nr_params 1
+
+	should "fail instantiating with wrong weights" do
+		assert_raise(TypeError) { Categorical.new(1) }
+		assert_raise(ArgumentError) { Categorical.new([]) }
+		assert_raise(ArgumentError) { Categorical.new([1, -1]) }
+		assert_raise(ArgumentError) { Categorical.new([0, 0.0]) }
+		assert_raise(ArgumentError) { Categorical.new([1, 0.0/0]) }
+		assert_raise(ArgumentError) { Categorical.new([1, 1.0/0]) }
+	end
+
+	should "fail instantiating without as many values as weights" do
+		assert_raise(ArgumentError) { Categorical.new([1, 2], [:a]) }
+	end
+
+	should "never draw a category of weight zero" do
+		x = Categorical.new [0, 3, 0, 1, 0]
+		x.outcomes(100_000).each do |sample|
+			assert(sample == 1 || sample == 3)
+		end
+	end
+
+	should "draw the categories with the frequencies of their weights" do
+		weights = [1, 2, 3, 4]
+		x = Categorical.new(weights, [:a, :b, :c, :d])
+		counts = Hash.new(0)
+		x.outcomes(200_000).each { |sample| counts[sample] += 1 }
+		[:a, :b, :c, :d].each_with_index do |value, i|
+			assert_in_delta(weights[i] / 10.0,
+					counts[value] / 200_000.0, 0.01)
+		end
+	end
+end
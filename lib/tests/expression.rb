@@ -0,0 +1,115 @@
+################################################################################
+#                                                                              #
+# File:     expression.rb                                                      #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/02/02                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::Expression < RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	# a random variable whose outcomes are always n
+	def constant(n)
+		DiscreteUniform.new(0, 1) * 0 + n
+	end
+
+	should "combine native random variables and numbers natively" do
+		x = Normal.new(0, 1)
+		assert_instance_of(Expression, x + 1)
+		assert_instance_of(Expression, (x + x) * 2.5 - x / 3)
+		assert_instance_of(Generic, x + Rational(1, 2))
+		assert(!RandomVariable.list.include?(Expression))
+	end
+
+	should "follow the semantics of Ruby's Integer and Float" do
+		[-7, -1, 0, 5, 12].each do |a|
+			[-3, -1, 2, 5].each do |b|
+				[:+, :-, :*, :/, :%].each do |op|
+					assert_equal(a.send(op, b),
+						constant(a).send(op, b).outcome)
+					assert_equal(a.send(op, b.to_f),
+						constant(a).send(op, 
+							b.to_f).outcome)
+				end
+			end
+		end
+		assert_equal(:int64, (constant(3) / 2).packed_type)
+		assert_equal(:float64, (constant(3) ** 2.0).packed_type)
+		assert_equal(9, (constant(3) ** 2).outcome)
+		assert_equal(Rational(1, 9), (constant(3) ** -2).outcome)
+	end
+
+	should "raise on integer divisions by zero" do
+		assert_raise(ZeroDivisionError) { (constant(3) / 0).outcome }
+		assert_raise(ZeroDivisionError) do
+			(constant(3) % 0).outcomes(10)
+		end
+		assert((constant(3) / 0.0).outcome.infinite?)
+	end
+
+	should "raise on Integer outcomes too big for 64 bits" do
+		x = DiscreteUniform.new(2**62, 2**62 + 1)
+		assert_raise(RangeError) { (x * 4).outcome }
+		assert_raise(RangeError) { (x + x + x).outcomes(10) }
+		assert_raise(RangeError) { (x * 4).outcomes(200_000) }
+		y = DiscreteUniform.new(-2**63, -2**63 + 1)
+		assert_raise(RangeError) { (y / -1).outcomes(100) }
+		assert_equal([0], (y % -1).outcomes(100).uniq)
+		assert_equal([0], (x - x + x * 1 - x).outcomes(200_000).uniq)
+		assert_in_delta(2.0**64, (x * 4.0).outcome, 2.0**12)
+	end
+
+	should "lift the functions of Math natively" do
+		x = RandomVariable.exp(Normal.new(0, 1))
+		assert_instance_of(Expression, x)
+		x.outcomes(1000).each { |sample| assert(sample > 0) }
+		assert_in_delta(Math.log(5),
+			RandomVariable.log(constant(5)).outcome, 1e-12)
+		assert(RandomVariable.sqrt(constant(-1)).outcome.nan?)
+		assert_equal(Math.sqrt(2), RandomVariable.sqrt(2))
+	end
+
+	should "sample a random variable appearing several times once" do
+		x = Normal.new(0, 1)
+		y = RandomVariable.exp(x) * (x - x) + x * x
+		assert((x - x).outcomes(1000).all?(&:zero?))
+		y.outcomes(1000).each { |sample| assert(sample >= 0) }
+		z = x + Rational(1, 2)
+		assert_instance_of(Generic, z)
+		(z - x).outcomes(1000).each do |sample|
+			assert_in_delta(0.5, sample, 1e-12)
+		end
+	end
+
+	should "share the outcomes of a joint draw with blocks" do
+		x = Normal.new(0, 1)
+		g = Generic.new { 0.0 }
+		assert_equal([0.0], ((x * 1.0) - (x + g)).outcomes(1000).uniq)
+		assert_equal([0.0], (x * 2 - (x + g) - x).outcomes(1000).uniq)
+		y = DiscreteUniform.new(1, 6)
+		z = (y * 2 + 1) - (y + Generic.new { 1 }) - y
+		assert_equal([0], z.outcomes(1000).uniq)
+		assert_equal(0.0, (RandomVariable.exp(x) - 
+				RandomVariable.exp(x + g)).outcome)
+	end
+
+	should "draw from the generator of its first random variable" do
+		gen = Generator.new(13)
+		x = Normal.new(0, 1, generator: gen)
+		assert_same(gen, (x * 2).generator)
+		assert_same(gen, (Normal.new + x).generator)
+		assert_same(gen, Mixture.new([Normal.new, x], [1, 1]).generator)
+		y = Normal.new(0, 1, generator: Generator.new(13))
+		assert_raise(ArgumentError) { x + y }
+		assert_raise(ArgumentError) { Mixture.new([x, y], [1, 1]) }
+	end
+end
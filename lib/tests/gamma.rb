@@ -0,0 +1,51 @@
+################################################################################
+#                                                                              #
+# File:     gamma.rb                                                           #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/02/16                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::Gamma < RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	should "fail instantiating with a non-positive parameter" do
+		assert_raise(ArgumentError) { Gamma.new(0) }
+		assert_raise(ArgumentError) { Gamma.new(-1, 1) }
+		assert_raise(ArgumentError) { Gamma.new(1, 0.0) }
+		assert_raise(ArgumentError) { Gamma.new(0.0/0, 1) }
+	end
+
+	should "have the mean and variance of its parameters" do
+		[:fast, :classic].each do |algorithm|
+			RandomVariable.algorithm = algorithm
+			[[0.2, 1.0], [1.0, 3.0], [7.5, 0.5]].each do |k, theta|
+				samples = Gamma.new(k, theta).outcomes(200_000)
+				mean = samples.sum / 200_000.0
+				var = samples.sum { |x| (x - mean)**2 } / 
+								199_999.0
+				assert_in_delta(1.0, mean / (k * theta), 0.02)
+				assert_in_delta(1.0, var / (k * theta**2), 0.05)
+			end
+		end
+	ensure
+		RandomVariable.algorithm = :fast
+	end
+
+	should "feed the Chi-Squared, F and Beta random variables" do
+		assert_in_delta(4.0, ChiSquared.new(4).outcomes(100_000).sum /
+						100_000.0, 0.05)
+		assert_in_delta(1.25, F.new(5, 10).outcomes(100_000).sum /
+						100_000.0, 0.03)
+		assert_in_delta(0.4, Beta.new(2, 3).outcomes(100_000).sum /
+						100_000.0, 0.005)
+	end
+end
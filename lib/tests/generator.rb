@@ -0,0 +1,112 @@
+################################################################################
+#                                                                              #
+# File:     generator.rb                                                       #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/01/12                                                         #
+#                                                                              #
+################################################################################
+
+class RandomVariable::Tests::Generator < Test::Unit::TestCase
+	include RandomVariable
+
+	should "keep the seed it was created with" do
+		assert_equal(113, Generator.new(113).seed)
+		assert_equal(2**100, Generator.new(2**100).seed)
+	end
+
+	should "fail being created with a non-integer seed" do
+		assert_raise(TypeError) { Generator.new("113") }
+	end
+
+	should "reproduce the same outcomes for the same seed value" do
+		x = Normal.new(0, 1, generator: Generator.new(113))
+		y = Normal.new(0, 1, generator: Generator.new(113))
+		assert_equal(x.outcomes(1_000), y.outcomes(1_000))
+	end
+
+	should "not be affected by the default generator" do
+		x = Poisson.new(10, generator: Generator.new(113))
+		samples = x.outcomes 1_000
+		x.generator.seed = 113
+		RandomVariable::new_seed
+		Poisson.new(10).outcomes 1_000
+		assert_equal(samples, x.outcomes(1_000))
+	end
+
+	should "draw from the default generator unless told otherwise" do
+		assert_same(Generator.default, Normal.new.generator)
+		assert_same(Generator.default,
+				Normal.new(generator: nil).generator)
+	end
+
+	should "draw random outcomes even if only allocated" do
+		g = Generator.allocate
+		h = Generator.new(0)
+		samples = Array.new(10) { g.rand }
+		assert_equal(Array.new(10) { h.rand }, samples)
+		assert_equal(10, samples.uniq.size)
+	end
+
+	should "fail binding a random variable to a non-generator" do
+		assert_raise(TypeError) { Normal.new(0, 1, generator: 113) }
+	end
+
+	should "split into streams that continue the parent stream" do
+		streams = Generator.new(113).split(3)
+		assert_equal(3, streams.length)
+		assert_equal(Generator.new(113).rand, streams[0].rand)
+		assert_equal(Generator.new(113).jump.jump.rand, streams[2].rand)
+		assert_nil(streams[1].seed)
+	end
+
+	should "restore the same stream after being marshaled" do
+		g = Generator.new(113)
+		g.rand
+		h = Marshal.load(Marshal.dump(g))
+		assert_equal(113, h.seed)
+		assert_equal(g.rand, h.rand)
+	end
+
+	should "reproduce the outcomes generated by several threads" do
+		threads = RandomVariable::threads
+		begin
+			RandomVariable::threads = 4
+			x = Normal.new(0, 1, generator: Generator.new(113))
+			samples = x.outcomes 500_000
+			x.generator.seed = 113
+			assert_equal(samples, x.outcomes(500_000))
+			summary = x.summarize(500_000, 
+					stats: [:mean, :quantiles])
+			RandomVariable::threads = 3
+			x.generator.seed = 113
+			assert_equal(samples, x.outcomes(500_000))
+			assert_equal(summary, x.summarize(500_000,
+					stats: [:mean, :quantiles]))
+		ensure
+			RandomVariable::threads = threads
+		end
+	end
+
+	should "go on generating outcomes once a signal is trapped" do
+		x = Normal.new(0, 1, generator: Generator.new(113))
+		samples = x.outcomes 3_000_000
+		x.generator.seed = 113
+		handler = trap("USR1") { }
+		begin
+			kill = Thread.new do
+				loop { Process.kill(:USR1, $$); sleep 0.001 }
+			end
+			assert_equal(samples, x.outcomes(3_000_000))
+		ensure
+			kill.kill.join
+			trap("USR1", handler)
+		end
+	end
+end
@@ -0,0 +1,56 @@
+################################################################################
+#                                                                              #
+# File:     mixture.rb                                                         #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/02/09                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::Mixture < RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	should "fail instantiating with wrong components or weights" do
+		x = Normal.new
+		assert_raise(TypeError) { Mixture.new([x, 1], [1, 1]) }
+		assert_raise(ArgumentError) { Mixture.new([x, x], [1]) }
+		assert_raise(ArgumentError) { Mixture.new([x, x], [1, -1]) }
+		assert_raise(ArgumentError) { Mixture.new([], []) }
+	end
+
+	should "draw the components with the frequencies of their weights" do
+		a = DiscreteUniform.new(0, 9)
+		b = DiscreteUniform.new(100, 109)
+		x = Mixture.new([a, b], [3, 1])
+		assert_equal(:int64, x.packed_type)
+		samples = x.outcomes(200_000)
+		samples.each { |sample| assert(sample < 10 || sample >= 100) }
+		high = samples.count { |sample| sample >= 100 }
+		assert_in_delta(0.25, high / 200_000.0, 0.01)
+	end
+
+	should "promote Integer outcomes when mixed with Float ones" do
+		x = Mixture.new([Bernoulli.new(0.5), Normal.new], [1, 1])
+		assert_equal(:float64, x.packed_type)
+		x.outcomes(1000).each do |sample|
+			assert_instance_of(Float, sample)
+		end
+	end
+
+	should "fall back to Ruby for other random variables" do
+		a = Normal.new + Rational(1, 2)
+		b = Categorical.new([1, 1], [:a, :b])
+		x = Mixture.new([a, b], [1, 1])
+		assert_instance_of(Generic, x)
+		x.outcomes(1000).each do |sample|
+			assert(sample.is_a?(Float) || [:a, :b].include?(sample))
+		end
+	end
+end
@@ -0,0 +1,70 @@
+################################################################################
+#                                                                              #
+# File:     multivariate_normal.rb                                             #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/02/09                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::MultivariateNormal < 
+					RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	MEAN = [1.0, -2.0, 0.5]
+	COV = [[4.0, 1.2, -0.6], [1.2, 1.0, 0.3], [-0.6, 0.3, 2.25]]
+
+	should "fail instantiating with a wrong covariance matrix" do
+		assert_raise(ArgumentError) { MultivariateNormal.new([], []) }
+		assert_raise(ArgumentError) do
+			MultivariateNormal.new([0, 0], [[1, 0]])
+		end
+		assert_raise(ArgumentError) do
+			MultivariateNormal.new([0, 0], [[1, 0.5], [0.4, 1]])
+		end
+		assert_raise(ArgumentError) do
+			MultivariateNormal.new([0, 0], [[1, 2], [2, 1]])
+		end
+	end
+
+	should "have the mean and covariance of its parameters" do
+		[:fast, :classic].each do |algorithm|
+			RandomVariable.algorithm = algorithm
+			x = MultivariateNormal.new(MEAN, COV)
+			samples = x.outcomes(200_000)
+			assert_equal(3, x.outcome.size)
+			mean = (0...3).map do |i|
+				samples.sum { |v| v[i] } / 200_000.0
+			end
+			3.times do |i|
+				assert_in_delta(MEAN[i], mean[i], 0.02)
+				3.times do |j|
+					cov = samples.sum do |v|
+						(v[i] - mean[i]) * 
+							(v[j] - mean[j])
+					end / 199_999.0
+					assert_in_delta(COV[i][j], cov, 0.05)
+				end
+			end
+		end
+	ensure
+		RandomVariable.algorithm = :fast
+	end
+
+	should "pack its outcomes one after the other" do
+		x = MultivariateNormal.new(MEAN, COV)
+		assert_equal(3 * 8 * 10, x.outcomes_packed(10).bytesize)
+		assert_equal(3, x.mean_of(1000).size)
+		x.generator = Generator.new(7)
+		a = x.outcomes_packed(5).unpack("E*")
+		x.generator = Generator.new(7)
+		assert_equal(a, x.outcomes(5).flatten)
+	end
+end
@@ -77,6 +77,23 @@ class RandomVariable::Tests::Poisson < RandomVariable::Tests::TestCase
 		end	
 	end	
 
+	should "have its parameter as both mean and variance" do
+		[:fast, :classic].each do |algorithm|
+			RandomVariable.algorithm = algorithm
+			[3, 10, 30, 1_000, 1e9].each do |param|
+				samples = Poisson.new(param).outcomes(100_000)
+				mean = samples.sum / 100_000.0
+				var = samples.sum { |x| (x - mean)**2 } / 
+								99_999.0
+				assert_in_delta(param, mean,
+					6 * Math.sqrt(param / 100_000.0))
+				assert_in_delta(1.0, var / param, 0.03)
+			end
+		end
+	ensure
+		RandomVariable.algorithm = :fast
+	end
+
 	should "be an upper-limit for the parameter" do
 		assert_raise(ArgumentError) do
 			Poisson.new(1e100)
@@ -0,0 +1,178 @@
+################################################################################
+#                                                                              #
+# File:     samples.rb                                                         #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Author:   Jorge F.M. Rinaldi                                                 #
+# Contact:  jorge.madronal.rinaldi@gmail.com                                   #
+#                                                                              #
+################################################################################
+#                                                                              #
+# Date:     2013/02/16                                                         #
+#                                                                              #
+################################################################################
+
+
+class RandomVariable::Tests::Samples < RandomVariable::Tests::TestCase
+	include RandomVariable
+
+	# the median by sorting the samples
+	def sorted_median(ary)
+		ary = ary.sort
+		i = ary.size / 2
+		ary.size.odd? ? ary[i] : (ary[i] + ary[i - 1]) / 2.0
+	end
+
+	should "agree with Ruby's own statistics" do
+		[1, 2, 3, 10, 1001, 50_000].each do |n|
+			[Normal.new, Poisson.new(4), 
+			 DiscreteUniform.new(-3, 3)].each do |x|
+				samples = x.outcomes(n)
+				assert_equal(samples.to_a.max, samples.max)
+				assert_equal(samples.to_a.min, samples.min)
+				assert_in_delta(samples.sum / n.to_f, 
+						samples.mean, 1e-9)
+				assert_equal(sorted_median(samples), 
+						samples.median)
+			end
+		end
+	end
+
+	should "deal with samples of mixed types" do
+		samples = Generic.new { 1 }.outcomes(4)
+		samples[0], samples[1] = 2.5, Rational(1, 2)
+		assert_equal(2.5, samples.max)
+		assert_equal(Rational(1, 2), samples.min)
+		assert_equal(1.25, samples.mean)
+		assert_equal(1.0, samples.median)
+		assert_nil(Generic.new { 1 }.outcomes(0).median)
+		not_an_array = Struct.new(:a).new(1).extend(Samples)
+		[:max, :min, :mean, :median].each do |stat|
+			assert_raise(TypeError) { not_an_array.send(stat) }
+		end
+	end
+
+	should "work out mergeable moments in a single pass" do
+		samples = Gamma.new(4.0, 2.0).outcomes(200_001)
+		m = samples.moments
+		assert_equal(200_001, m.count)
+		assert_in_delta(samples.mean, m.mean, 1e-9)
+		var = samples.sum { |x| (x - m.mean)**2 } / 200_000.0
+		assert_in_delta(1.0, samples.variance / var, 1e-9)
+		assert_in_delta(1.0, samples.skewness, 0.05)
+		assert_in_delta(1.5, samples.kurtosis, 0.2)
+
+		parts = samples.each_slice(70_001).map do |part|
+			part.each_with_object(Moments.new) { |x, acc| acc << x }
+		end
+		merged = parts.inject(Moments.new) do |acc, part|
+			acc.merge(part)
+		end
+		[:count, :mean, :variance, :skewness, :kurtosis].each do |stat|
+			assert_in_delta(m.send(stat), merged.send(stat), 1e-9)
+		end
+		assert_nil(Moments.new.mean)
+		assert_nil(Moments.new.concat([1]).variance)
+	end
+
+	should "summarize outcomes without keeping them" do
+		s = Normal.new(2.0, 3.0).summarize(2_000_000,
+				stats: [:count, :mean, :var, :min, :max])
+		assert_equal(2_000_000, s[:count])
+		assert_in_delta(2.0, s[:mean], 0.01)
+		assert_in_delta(9.0, s[:var], 0.05)
+		assert(s[:min] < -10 && s[:max] > 14)
+
+		s = DiscreteUniform.new(1, 6).summarize(100_000)
+		assert_equal([1, 6], [s[:min], s[:max]])
+		s = Generic.new { 7 }.summarize(10, stats: [:mean, :max])
+		assert_equal({ mean: 7.0, max: 7 }, s)
+		assert_nil(Poisson.new(3).summarize(0)[:mean])
+		assert_raise(ArgumentError) { Poisson.new(3).summarize(9, 
+							stats: [:mode]) }
+		assert_raise(ArgumentError) { Poisson.new(3).summarize(9, 
+			stats: [:quantiles], compression: Float::NAN) }
+		assert_raise(ArgumentError) do
+			Categorical.new([1, 1], [:a, :b]).summarize(9)
+		end
+		assert_raise(ArgumentError) do
+			x = MultivariateNormal.new([0, 0], [[1, 0], [0, 1]])
+			x.summarize(9)
+		end
+	end
+
+	should "sketch the quantiles with mergeable t-digests" do
+		x = Exponential.new(1.0)
+		s = x.summarize(1_000_000, stats: [:quantiles, :digest])
+		[0.5, 0.95, 0.99, 0.999].each do |q|
+			exact = -Math.log(1 - q)
+			assert_in_delta(exact, s[:quantiles][q], 0.02 * exact)
+		end
+
+		samples = x.outcomes(100_000)
+		sorted = samples.sort
+		parts = samples.each_slice(30_000).map do |part|
+			TDigest.new.concat(part)
+		end
+		merged = parts.inject { |acc, part| acc.merge(part) }
+		assert_equal(100_000, merged.count)
+		assert_equal(sorted.first, merged.quantile(0))
+		assert_equal(sorted.last, merged.quantile(1))
+		[0.01, 0.5, 0.99].each do |q|
+			quantile = merged.quantile(q)
+			rank = sorted.bsearch_index { |v| v >= quantile }
+			assert_in_delta(q, rank / 100_000.0, 0.005)
+		end
+		assert_nil(TDigest.new.quantile(0.5))
+		assert_equal(3.0, TDigest.new.concat([5, 1, 3]).quantile(0.5))
+		assert_in_delta(Math.log(2), samples.digest(100).quantile(0.5),
+							0.03)
+	end
+
+	should "count the samples into linear and log bins" do
+		samples = Normal.new(0, 2).outcomes(100_000)
+		h = samples.histogram(range: -4...4, bins: 16)
+		assert_equal((0..16).map { |i| -4 + i * 0.5 }, h.edges)
+		h.edges.each_cons(2).zip(h.counts) do |(lo, hi), n|
+			assert_equal(samples.count { |x| x >= lo && x < hi }, n)
+		end
+		assert_equal(samples.count { |x| x < -4 }, h.underflow)
+		assert_equal(samples.count { |x| x >= 4 }, h.overflow)
+		assert_equal(100_000, h.count)
+
+		h = Histogram.new(0...10, 10).concat([-1e-17, 0.0, 9.99, 10])
+		assert_equal([1, 1, 1], 
+				[h.underflow, h.counts.first, h.overflow])
+
+		h = Histogram.new(1..1000, 4, :log)
+		assert_equal(1.0...1024.0, h.range)
+		assert_equal([1.0, 1.25, 1.5, 1.75, 2.0], h.edges.first(5))
+		h.concat([0, -3, 1, 1.3, 1.9999, 1023.9, 1024, 0.0 / 0])
+		assert_equal([1, 1, 0, 1], h.counts.first(4))
+		assert_equal([1, 2, 2], 
+				[h.counts.last, h.underflow, h.overflow])
+		assert_raise(ArgumentError) { Histogram.new(0..1, 4, :log) }
+		assert_raise(ArgumentError) { Histogram.new(1..2, 3, :log) }
+		assert_raise(ArgumentError) { Histogram.new(1..1) }
+	end
+
+	should "build mergeable histograms of outcomes natively" do
+		x = Exponential.new(1.0)
+		h = x.histogram(1_000_000, range: 0...5, bins: 5)
+		assert_equal(1_000_000, h.count)
+		h.counts.each_with_index do |n, i|
+			p = Math.exp(-i) - Math.exp(-i - 1)
+			assert_in_delta(p, n / 1_000_000.0, 0.003)
+		end
+		x.histogram(1_000, into: h)
+		assert_equal(1_001_000, h.count)
+		g = Generic.new { 2.5 }.histogram(10, range: 0...5, bins: 5)
+		assert_equal([0, 0, 10, 0, 0], g.counts)
+		assert_equal(1_001_010, h.merge(g).count)
+		assert_equal(1_001_000, h.count)
+		assert_raise(ArgumentError) do
+			h.merge!(Histogram.new(0...5, 10))
+		end
+	end
+end